@@ -0,0 +1,248 @@
+// Load generator for the list_tasks and list_tasks_dfs modules: forks a
+// tree of sleeping processes, fanout children per process down to the
+// given depth, plus one chain of processes each the child of the one
+// before (a tree that is deep rather than wide).  With -r it then reads
+// /proc/list_tasks and /proc/list_tasks_dfs that many times each and
+// compares the cost of the two walks, from the "# tasks, max depth, ns"
+// line the modules end their listings with (both time copying the
+// tasks out under the RCU read lock, and the DFS module also putting
+// its copy in tree order, but not the formatting of the listing);
+// otherwise it waits for
+// Enter, for the listings to be read by hand.  Then the tree exits.
+//
+// to compile enter:
+//    cc -Wall -O2 forktree.c
+// usage:
+//    ./a.out [-f fanout] [-d depth] [-c chain] [-r repeats]
+//       -f  children per process in the tree (default 4)
+//       -d  levels of children below this process (default 4, so 340 processes)
+//       -c  length of the chain, also below this process (default 0)
+//       -r  times to read each listing (default 0: wait for Enter instead)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_PROCESSES 100000
+
+static const char* const listings[] = {"/proc/list_tasks", "/proc/list_tasks_dfs"};
+#define NUM_LISTINGS (int)(sizeof(listings) / sizeof(listings[0]))
+
+// Every process writes a byte to ready once its children are forked, and
+// then blocks reading release until the root closes its end (or exits,
+// so killing the root ends the whole tree).
+static int ready[2], release[2];
+
+typedef struct {
+    int reads;
+    unsigned long tasks;       // of the last read
+    int max_depth;             // of the last read
+    unsigned long long min_ns, max_ns, total_ns;
+} walk_stats_t;
+
+// Once a process has forked its children it is done with ready: closing
+// it then lets the root see the end of the pipe if some forks failed.
+static void signal_ready(void) {
+    if (write(ready[1], "", 1) != 1) {
+        perror("write");
+    }
+    close(ready[1]);
+}
+
+// Waits for the release, then for its own children, and exits.
+static void wait_and_exit(void) {
+    char byte;
+    while (read(release[0], &byte, 1) < 0) {
+    }
+    while (wait(NULL) > 0) {
+    }
+    exit(0);
+}
+
+// Forks count children; returns 0 in the parent, and in each child its
+// number from 1.
+static int fork_children(int count) {
+    for (int i = 1; i <= count; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 0; // the tree comes out smaller; the root notices
+        }
+        if (pid == 0) {
+            close(release[1]);
+            return i;
+        }
+    }
+    return 0;
+}
+
+// Runs in each process of the tree at the given level below the root.
+static void grow_tree(int fanout, int level, int depth) {
+    while (level < depth && fork_children(fanout) != 0) {
+        level++;
+    }
+    signal_ready();
+    wait_and_exit();
+}
+
+static void grow_chain(int length) {
+    while (length > 0 && fork_children(1) != 0) {
+        length--;
+    }
+    signal_ready();
+    wait_and_exit();
+}
+
+// Reads the whole listing into buffer (grown as needed) and returns its
+// length, or -1.
+static long read_listing(const char* path, char** buffer, size_t* capacity) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    size_t len = 0, got;
+    do {
+        if (len + 1 >= *capacity) {
+            size_t bigger = *capacity ? 2 * *capacity : 1 << 16;
+            char* grown = realloc(*buffer, bigger);
+            if (grown == NULL) {
+                fclose(file);
+                return -1;
+            }
+            *buffer = grown;
+            *capacity = bigger;
+        }
+        got = fread(*buffer + len, 1, *capacity - len - 1, file);
+        len += got;
+    } while (got > 0);
+    fclose(file);
+    (*buffer)[len] = '\0';
+    return (long)len;
+}
+
+// Adds the footer of a listing to stats.  Returns 0, or -1 if there is
+// none (an older module).
+static int add_footer(const char* text, walk_stats_t* stats) {
+    const char* footer = strstr(text, "\n# ");
+    const char* next;
+    while (footer != NULL && (next = strstr(footer + 1, "\n# ")) != NULL) {
+        footer = next; // the delta header also starts with "# "
+    }
+    unsigned long long ns;
+    if (footer == NULL ||
+        sscanf(footer, "\n# %lu tasks, max depth %d, %llu ns", &stats->tasks,
+               &stats->max_depth, &ns) != 3) {
+        return -1;
+    }
+    if (stats->reads == 0 || ns < stats->min_ns) {
+        stats->min_ns = ns;
+    }
+    if (ns > stats->max_ns) {
+        stats->max_ns = ns;
+    }
+    stats->total_ns += ns;
+    stats->reads++;
+    return 0;
+}
+
+static int compare_walks(int repeats) {
+    char* buffer = NULL;
+    size_t capacity = 0;
+
+    printf("Listing              | Reads |  Tasks | Depth | min ns     | avg ns     "
+           "| max ns     | avg ns/task\n");
+    for (int l = 0; l < NUM_LISTINGS; l++) {
+        walk_stats_t stats = {0};
+        for (int k = 0; k < repeats; k++) {
+            if (read_listing(listings[l], &buffer, &capacity) < 0) {
+                printf("Could not read %s (is the module loaded?)\n", listings[l]);
+                break;
+            }
+            if (add_footer(buffer, &stats) != 0) {
+                printf("No walk statistics at the end of %s\n", listings[l]);
+                break;
+            }
+        }
+        if (stats.reads > 0) {
+            double avg = (double)stats.total_ns / stats.reads;
+            printf("%-20s | %5d | %6lu | %5d | %10llu | %10.0f | %10llu | %11.1f\n",
+                   listings[l], stats.reads, stats.tasks, stats.max_depth, stats.min_ns, avg,
+                   stats.max_ns, stats.tasks ? avg / stats.tasks : 0.0);
+        }
+    }
+    free(buffer);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int fanout = 4, depth = 4, chain = 0, repeats = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:d:c:r:")) != -1) {
+        switch (opt) {
+        case 'f': fanout = atoi(optarg); break;
+        case 'd': depth = atoi(optarg); break;
+        case 'c': chain = atoi(optarg); break;
+        case 'r': repeats = atoi(optarg); break;
+        default:
+            printf("Usage: %s [-f fanout] [-d depth] [-c chain] [-r repeats]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (fanout < 0 || depth < 0 || chain < 0) {
+        printf("Fanout, depth and chain can't be negative\n");
+        return 1;
+    }
+
+    // processes below this one: fanout + fanout^2 + ... + fanout^depth, and the chain
+    long expected = chain, level = 1;
+    for (int i = 0; i < depth && fanout > 0; i++) {
+        level *= fanout;
+        expected += level;
+        if (expected > MAX_PROCESSES) {
+            printf("More than %d processes\n", MAX_PROCESSES);
+            return 1;
+        }
+    }
+    if (pipe(ready) != 0 || pipe(release) != 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    // the root's first fanout children each grow one subtree; the chain hangs off the root too
+    if (depth > 0 && fork_children(fanout) != 0) {
+        grow_tree(fanout, 1, depth);
+    }
+    if (chain > 0 && fork_children(1) != 0) {
+        grow_chain(chain - 1);
+    }
+
+    // one byte per process (the leaves and the inner ones alike)
+    close(ready[1]);
+    long started = 0;
+    char bytes[4096];
+    ssize_t got;
+    while ((got = read(ready[0], bytes, sizeof(bytes))) > 0) {
+        started += got;
+        if (started == expected) {
+            break;
+        }
+    }
+    printf("%ld processes below pid %d (fanout %d, depth %d, chain %d)%s\n", started,
+           (int)getpid(), fanout, depth, chain,
+           started < expected ? ": some forks failed" : "");
+
+    if (repeats > 0) {
+        compare_walks(repeats);
+    } else {
+        printf("Press Enter to end them\n");
+        getchar();
+    }
+
+    close(release[1]); // every read() of release returns 0 now
+    while (wait(NULL) > 0) {
+    }
+    return 0;
+}
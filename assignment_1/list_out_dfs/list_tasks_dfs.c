@@ -3,43 +3,314 @@
 #include <linux/init.h>
 #include <linux/sched/signal.h>
 #include <linux/sched.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/rcupdate.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/slab.h>
+#include <linux/sort.h>
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Your Name");
 MODULE_DESCRIPTION("DFS iteration over tasks");
 
-// Function to perform DFS on the task list
-static void dfs(struct task_struct *task) {
-    struct task_struct *child;
-    struct list_head *list;
+#define PROC_NAME "list_tasks_dfs"
 
-    // Output the current task's name, state, and PID
-    //printk(KERN_INFO "%s\t\t%ld\t%d\n", task->comm, task->__state, task->pid);
-    //printk(KERN_INFO "%-16s\t%-6u\t%d\n", task->comm, task->__state, task->pid);
+// A task as the walk copied it
+struct dfs_entry {
+    char comm[TASK_COMM_LEN];
+    pid_t pid;
+    pid_t ppid;       // tgid of the real parent
+    int depth;        // parent links from init_task, filled in by the DFS
+    char state;
+};
 
-    printk(KERN_INFO "%-16s\t%x\t%d\n", task->comm, task->__state, task->pid);
+// The tree over a copy, by index: -1 for none
+struct dfs_node {
+    int parent;
+    int first_child;
+    int next_sibling;
+};
 
-    // Recursively apply DFS to each child
-    list_for_each(list, &task->children) {
-        child = list_entry(list, struct task_struct, sibling);
-        dfs(child);
+struct dfs_stats {
+    size_t tasks;     // tasks listed
+    int max_depth;    // deepest task, init_task being depth 0
+    u64 ns;           // time to copy the tasks and put them in tree order
+};
+
+static size_t count_tasks(void) {
+    struct task_struct *task;
+    size_t count = 1; // init_task, which for_each_process() skips
+
+    rcu_read_lock();
+    for_each_process(task) {
+        count++;
     }
+    rcu_read_unlock();
+    return count;
 }
 
-static int __init dfs_init(void) {
-    printk(KERN_INFO "Loading DFS module...\n");
-    printk(KERN_INFO "Command\t\tState\tPID\n");
+// Copies init_task and every process, at most capacity of them, in one
+// RCU pass.  The task list is safe to follow under RCU; the children
+// lists are not (a parent that exits moves its children to another
+// list, and a walk of them can step onto the other list's head), so the
+// tree is built from the copy instead.  Returns how many were copied,
+// or -1 if they didn't fit.
+static long copy_tasks(struct dfs_entry *entries, size_t capacity) {
+    struct task_struct *task = &init_task;
+    size_t count = 0;
+
+    rcu_read_lock();
+    do {
+        struct dfs_entry *entry;
+
+        if (count == capacity) {
+            rcu_read_unlock();
+            return -1;
+        }
+        entry = &entries[count++];
+        get_task_comm(entry->comm, task);
+        entry->state = task_state_to_char(task);
+        entry->pid = task->pid;
+        entry->ppid = task == &init_task ? -1 : rcu_dereference(task->real_parent)->tgid;
+        task = next_task(task);
+    } while (task != &init_task);
+    rcu_read_unlock();
+    return count;
+}
+
+static int compare_pids(const void *a, const void *b) {
+    const struct dfs_entry *x = a, *y = b;
+
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+// The entry with the pid, in entries[] sorted by pid, or -1
+static int find_entry(const struct dfs_entry *entries, int count, pid_t pid) {
+    int low = 0, high = count - 1;
+
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+
+        if (entries[mid].pid == pid) {
+            return mid;
+        }
+        if (entries[mid].pid < pid) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+// Links each entry under its parent, children in pid order.  entries[0]
+// is init_task (pid 0); a task whose parent wasn't copied (it exited
+// during the walk) goes under it too.
+static void build_tree(const struct dfs_entry *entries, struct dfs_node *nodes, int count) {
+    for (int i = 0; i < count; i++) {
+        nodes[i].first_child = -1;
+        nodes[i].next_sibling = -1;
+    }
+    nodes[0].parent = -1;
+    for (int i = count - 1; i > 0; i--) {
+        int parent = find_entry(entries, count, entries[i].ppid);
+
+        if (parent < 0 || parent == i) {
+            parent = 0;
+        }
+        nodes[i].parent = parent;
+        nodes[i].next_sibling = nodes[parent].first_child;
+        nodes[parent].first_child = i;
+    }
+}
+
+// Depth-first from init_task without recursion, so deep trees can't
+// overflow the kernel stack: go down to the first child, and when a
+// task has no children climb back up the parent links until an
+// ancestor has a next sibling.  Copies the entries to out[] in that
+// order, with their depth, and returns how many.  A task whose parent
+// links loop (a pid reused during the copy) can't be reached, and is
+// left out.
+static size_t dfs(const struct dfs_entry *entries, const struct dfs_node *nodes,
+                  struct dfs_entry *out, struct dfs_stats *stats) {
+    size_t count = 0;
+    int i = 0, depth = 0;
+
+    stats->max_depth = 0;
+    while (1) {
+        out[count] = entries[i];
+        out[count++].depth = depth;
+        stats->max_depth = max(stats->max_depth, depth);
+
+        if (nodes[i].first_child >= 0) {
+            i = nodes[i].first_child;
+            depth++;
+            continue;
+        }
+        while (i != 0 && nodes[i].next_sibling < 0) {
+            i = nodes[i].parent;
+            depth--;
+        }
+        if (i == 0) {
+            return count;
+        }
+        i = nodes[i].next_sibling;
+    }
+}
+
+// Per open file: the listing being streamed
+struct dfs_state {
+    struct dfs_entry *entries;    // in DFS order
+    struct dfs_stats stats;
+};
+
+// Copies the tasks and puts them in DFS order.  Tasks forked between
+// counting and copying get some slack; if even that isn't enough, count
+// again.
+static int take_listing(struct dfs_state *state) {
+    struct dfs_entry *copy;
+    struct dfs_node *nodes;
+    long count;
+    u64 start;
+
+    while (1) {
+        size_t capacity = count_tasks() + 64;
+
+        copy = kvmalloc_array(capacity, sizeof(struct dfs_entry), GFP_KERNEL);
+        nodes = kvmalloc_array(capacity, sizeof(struct dfs_node), GFP_KERNEL);
+        state->entries = kvmalloc_array(capacity, sizeof(struct dfs_entry), GFP_KERNEL);
+        if (!copy || !nodes || !state->entries) {
+            break;
+        }
+        start = ktime_get_ns();
+        count = copy_tasks(copy, capacity);
+        if (count >= 0) {
+            sort(copy, count, sizeof(struct dfs_entry), compare_pids, NULL);
+            build_tree(copy, nodes, count);
+            state->stats.tasks = dfs(copy, nodes, state->entries, &state->stats);
+            state->stats.ns = ktime_get_ns() - start;
+            kvfree(nodes);
+            kvfree(copy);
+            return 0;
+        }
+        kvfree(state->entries);
+        kvfree(nodes);
+        kvfree(copy);
+    }
+    kvfree(state->entries);
+    kvfree(nodes);
+    kvfree(copy);
+    state->entries = NULL;
+    return -ENOMEM;
+}
 
-    // Start DFS from the init_task
-    dfs(&init_task);
+// Stands for the last line, after the tasks, like SEQ_START_TOKEN for
+// the first
+#define SEQ_FOOTER_TOKEN ((void *)2)
 
+// The entry at pos, or the footer after the last one
+static void *seq_item(struct dfs_state *state, loff_t pos) {
+    if (!state->entries || pos > state->stats.tasks + 1) {
+        return NULL;
+    }
+    if (pos == state->stats.tasks + 1) {
+        return SEQ_FOOTER_TOKEN;
+    }
+    return &state->entries[pos - 1];
+}
+
+// The tree order only comes out of a whole walk, so the walk is copied
+// once, when reading starts from the beginning (a new open, or after
+// lseek() to 0), and seq_file then prints it a page at a time: position
+// 0 is the header, task i is at position i + 1, and the footer with the
+// cost of the walk comes last.
+static void *list_tasks_dfs_seq_start(struct seq_file *m, loff_t *pos) {
+    struct dfs_state *state = m->private;
+
+    if (*pos == 0) {
+        int err;
+
+        kvfree(state->entries);
+        state->entries = NULL;
+        err = take_listing(state);
+        if (err != 0) {
+            return ERR_PTR(err);
+        }
+        return SEQ_START_TOKEN;
+    }
+    return seq_item(state, *pos);
+}
+
+static void *list_tasks_dfs_seq_next(struct seq_file *m, void *v, loff_t *pos) {
+    struct dfs_state *state = m->private;
+
+    ++*pos;
+    return seq_item(state, *pos);
+}
+
+static void list_tasks_dfs_seq_stop(struct seq_file *m, void *v) {
+}
+
+static int list_tasks_dfs_seq_show(struct seq_file *m, void *v) {
+    struct dfs_state *state = m->private;
+    struct dfs_stats *stats = &state->stats;
+    struct dfs_entry *entry = v;
+
+    if (v == SEQ_START_TOKEN) {
+        seq_puts(m, "Command\t\t\tState\tPID\tDepth\n");
+        return 0;
+    }
+    if (v == SEQ_FOOTER_TOKEN) {
+        seq_printf(m, "# %zu tasks, max depth %d, %llu ns (%llu ns/task)\n", stats->tasks,
+                   stats->max_depth, stats->ns, div_u64(stats->ns, stats->tasks));
+        return 0;
+    }
+    seq_printf(m, "%-16s\t%c\t%d\t%d\n", entry->comm, entry->state, entry->pid,
+               entry->depth);
+    return 0;
+}
+
+static const struct seq_operations list_tasks_dfs_seq_ops = {
+    .start = list_tasks_dfs_seq_start,
+    .next  = list_tasks_dfs_seq_next,
+    .stop  = list_tasks_dfs_seq_stop,
+    .show  = list_tasks_dfs_seq_show,
+};
+
+static int list_tasks_dfs_open(struct inode *inode, struct file *file) {
+    return seq_open_private(file, &list_tasks_dfs_seq_ops, sizeof(struct dfs_state));
+}
+
+static int list_tasks_dfs_release(struct inode *inode, struct file *file) {
+    struct seq_file *m = file->private_data;
+    struct dfs_state *state = m->private;
+
+    kvfree(state->entries);
+    return seq_release_private(inode, file);
+}
+
+static const struct proc_ops list_tasks_dfs_proc_ops = {
+    .proc_open    = list_tasks_dfs_open,
+    .proc_read    = seq_read,
+    .proc_lseek   = seq_lseek,
+    .proc_release = list_tasks_dfs_release,
+};
+
+static int __init dfs_init(void) {
+    if (!proc_create(PROC_NAME, 0444, NULL, &list_tasks_dfs_proc_ops)) {
+        return -ENOMEM;
+    }
+
+    printk(KERN_INFO "Loading DFS module: cat /proc/%s\n", PROC_NAME);
     return 0; // A non 0 return means init_module failed; module can't be loaded.
 }
 
 static void __exit dfs_exit(void) {
+    remove_proc_entry(PROC_NAME, NULL);
     printk(KERN_INFO "Removing DFS module...\n");
 }
 
 module_init(dfs_init);
 module_exit(dfs_exit);
-
@@ -3,34 +3,710 @@
 #include <linux/init.h>
 #include <linux/sched.h>
 #include <linux/sched/signal.h>
+#include <linux/sched/mm.h>
+#include <linux/mm.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/rcupdate.h>
+#include <linux/vmalloc.h>
+#include <linux/slab.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/sort.h>
+#include <linux/string.h>
+#include <linux/cgroup.h>
+#include <linux/math64.h>
+
+#include "task_record.h"
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Your Name");
 MODULE_DESCRIPTION("List tasks with their command and PID, and human-readable state.");
 
-static int __init list_tasks_start(void) {
-    struct task_struct *task;
+#define PROC_NAME "list_tasks"
+#define BIN_NAME  "list_tasks_bin"
+
+static bool usage;
+module_param(usage, bool, 0644);
+MODULE_PARM_DESC(usage, "Add RSS and CPU time to /proc/" BIN_NAME " (takes a lock per task)");
+
+// Filters, read at the start of every snapshot, so they can be changed
+// through /sys/module/list_tasks/parameters while the module is loaded
+static char state_filter[16];
+module_param_string(states, state_filter, sizeof(state_filter), 0644);
+MODULE_PARM_DESC(states, "Only tasks in these states, like \"RD\" (default: all); with "
+                 "threads, only threads in them, under every process that has one");
+
+static unsigned long long cgroup_filter;
+module_param_named(cgroup, cgroup_filter, ullong, 0644);
+MODULE_PARM_DESC(cgroup, "Only tasks in this cgroup (v2) or below it, by id: the inode "
+                 "number of its directory (default 0: all)");
+
+static int root_filter;
+module_param_named(root, root_filter, int, 0644);
+MODULE_PARM_DESC(root, "Only this process and its descendants, by pid (default 0: all)");
+
+static bool threads;
+module_param(threads, bool, 0644);
+MODULE_PARM_DESC(threads, "List every thread under its process, and thread counts and CPU "
+                 "time per process");
+
+static bool delta;
+module_param(delta, bool, 0644);
+MODULE_PARM_DESC(delta, "List only the tasks created or exited since the previous read (of "
+                 "those the filters let through)");
+
+struct task_filter {
+    char states[sizeof(state_filter)];
+    u64 cgroup;
+    pid_t root;
+};
+
+// Identifies a task across snapshots: a pid can be reused, but not with
+// the same start time
+struct task_key {
+    pid_t pid;
+    u32 index;        // its record in the snapshot
+    u64 start_time;
+    bool listed;      // whether it passed the filters
+};
+
+// A header and its records in one vmalloc_user() buffer, so the binary
+// file can hand it to mmap() as is
+struct task_snapshot {
+    struct task_snapshot_header *header;
+    size_t size;              // bytes of header and records
+    struct task_key *keys;    // sorted, for the delta baseline (else NULL);
+                              //   then every task has a record, filtered or not
+};
+
+// What the next delta is taken against, shared by both files, and the
+// number of deltas taken so far
+static struct task_snapshot baseline;
+static u64 generation;
+static DEFINE_MUTEX(delta_mutex);
+
+// Per open file: the snapshot being streamed
+struct list_state {
+    struct task_snapshot snap;
+};
+
+static struct task_record *snapshot_record(const struct task_snapshot *snap, size_t i) {
+    return (struct task_record *)((char *)snap->header + snap->header->header_size +
+                                  i * snap->header->record_size);
+}
+
+static void free_snapshot(struct task_snapshot *snap) {
+    vfree(snap->header);
+    vfree(snap->keys);
+    snap->header = NULL;
+    snap->keys = NULL;
+    snap->size = 0;
+}
 
-    printk(KERN_INFO "Loading list_tasks module...\n");
-    printk(KERN_INFO "Command\t\tState\tPID\n");
+// Room for capacity records, zeroed (so no padding leaks out) with the
+// header filled in but no records yet
+static int alloc_snapshot(struct task_snapshot *snap, size_t capacity, size_t record_size,
+                          u32 flags) {
+    snap->keys = NULL;
+    snap->size = sizeof(struct task_snapshot_header) + capacity * record_size;
+    snap->header = vmalloc_user(snap->size);
+    if (!snap->header) {
+        snap->size = 0;
+        return -ENOMEM;
+    }
+    snap->header->magic = TASK_SNAPSHOT_MAGIC;
+    snap->header->version = TASK_SNAPSHOT_VERSION;
+    snap->header->header_size = sizeof(struct task_snapshot_header);
+    snap->header->record_size = record_size;
+    snap->header->flags = flags;
+    snap->header->taken_ns = ktime_get_boottime_ns();
+    return 0;
+}
 
+// Cuts the snapshot down to its first count records
+static void set_count(struct task_snapshot *snap, size_t count) {
+    snap->header->count = count;
+    snap->size = sizeof(struct task_snapshot_header) + count * snap->header->record_size;
+}
+
+static void get_filter(struct task_filter *filter) {
+    strscpy(filter->states, state_filter, sizeof(filter->states));
+    filter->cgroup = READ_ONCE(cgroup_filter);
+    filter->root = READ_ONCE(root_filter);
+}
+
+static size_t count_tasks(int with_threads) {
+    struct task_struct *task;
+    size_t count = 0;
+
+    rcu_read_lock();
     for_each_process(task) {
-        // Use task_state_to_char() to get the task's state as a character
-        char task_state = task_state_to_char(task);
-        
-        // task->comm: command name of the task
-        // task->pid: PID of the task
-        // task_state: human-readable character representing the task's state
-        printk(KERN_INFO "%s\t\t%c\t%d\n", task->comm, task_state, task->pid);
+        count += with_threads ? get_nr_threads(task) : 1;
+    }
+    rcu_read_unlock();
+    return count;
+}
+
+// Parent links from task up to init_task.  Sets *below_root if the
+// process root is task or one of its ancestors.
+static int task_depth(struct task_struct *task, pid_t root, int *below_root) {
+    int depth = 0;
+
+    *below_root = (task->tgid == root);
+    while (task != &init_task && depth < U16_MAX) {
+        task = rcu_dereference(task->real_parent);
+        *below_root |= (task->tgid == root);
+        depth++;
+    }
+    return depth;
+}
+
+// Whether the task's cgroup (on the v2 hierarchy), or one above it, has
+// the id
+static int in_cgroup(struct task_struct *task, u64 id) {
+#ifdef CONFIG_CGROUPS
+    struct cgroup *cgrp;
+
+    for (cgrp = task_dfl_cgroup(task); cgrp; cgrp = cgroup_parent(cgrp)) {
+        if (cgroup_id(cgrp) == id) {
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+static int state_wanted(struct task_struct *task, const struct task_filter *filter) {
+    return !filter->states[0] || strchr(filter->states, task_state_to_char(task));
+}
+
+// Whether any thread of the process is in one of the filter's states
+static int any_thread_wanted(struct task_struct *task, const struct task_filter *filter) {
+    struct task_struct *thread;
+
+    if (!filter->states[0]) {
+        return 1;
+    }
+    for_each_thread(task, thread) {
+        if (state_wanted(thread, filter)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Whether the process passes the filter; its depth goes to *depth.  With
+// with_threads the state filter is left to the threads: a process
+// passes if any thread is in one of its states.  The cheap tests go
+// first.
+static int wanted(struct task_struct *task, const struct task_filter *filter, int with_threads,
+                  int *depth) {
+    int below_root;
+
+    if (!with_threads && !state_wanted(task, filter)) {
+        return 0;
+    }
+    if (filter->cgroup && !in_cgroup(task, filter->cgroup)) {
+        return 0;
+    }
+    *depth = task_depth(task, filter->root, &below_root);
+    if (filter->root && !below_root) {
+        return 0;
+    }
+    return !with_threads || any_thread_wanted(task, filter);
+}
+
+static void fill_record(struct task_struct *task, int depth, struct task_record *record) {
+    record->pid = task->pid;
+    record->ppid = rcu_dereference(task->real_parent)->tgid;
+    record->depth = depth;
+    // Use task_state_to_char() to get the task's state as a character
+    record->state = task_state_to_char(task);
+    get_task_comm(record->comm, task);
+}
+
+// task_lock() keeps task->mm from going away while its counters are read
+static void fill_rss(struct task_struct *task, struct task_record_usage *record) {
+    task_lock(task);
+    record->rss_pages = task->mm ? get_mm_rss(task->mm) : 0;
+    task_unlock(task);
+}
+
+// RSS of the process and CPU time of all its threads
+static void fill_usage(struct task_struct *task, struct task_record_usage *record) {
+    struct task_struct *thread;
+
+    fill_rss(task, record);
+
+    // threads that already exited were added to the signal struct
+    record->utime_ns = task->signal->utime;
+    record->stime_ns = task->signal->stime;
+    for_each_thread(task, thread) {
+        record->utime_ns += READ_ONCE(thread->utime);
+        record->stime_ns += READ_ONCE(thread->stime);
+    }
+}
+
+static void add_key(struct task_snapshot *snap, size_t index, struct task_struct *task,
+                    int listed) {
+    if (snap->keys) {
+        snap->keys[index].pid = task->pid;
+        snap->keys[index].index = index;
+        snap->keys[index].start_time = task->start_time;
+        snap->keys[index].listed = listed;
+    }
+}
+
+// Fills in the process totals in its leader's record, at index leader,
+// and adds a record after *count for each of its other threads that is
+// in the filter's states (or each of them, for a delta, which keeps
+// them all).  One pass over the threads does both.  Returns the threads
+// seen, or -1 if the records didn't fit.
+static int add_threads(struct task_snapshot *snap, struct task_struct *task, int depth,
+                       const struct task_filter *filter, int listed, size_t leader,
+                       size_t *count, size_t capacity) {
+    struct task_record_thread *summary =
+        (struct task_record_thread *)snapshot_record(snap, leader);
+    struct task_struct *thread;
+
+    summary->tgid = task->tgid;
+    // threads that already exited were added to the signal struct
+    summary->usage.utime_ns = task->signal->utime;
+    summary->usage.stime_ns = task->signal->stime;
+    for_each_thread(task, thread) {
+        u64 utime = READ_ONCE(thread->utime);
+        u64 stime = READ_ONCE(thread->stime);
+        struct task_record_thread *record;
+        int thread_listed;
+
+        summary->threads++;
+        summary->usage.utime_ns += utime;
+        summary->usage.stime_ns += stime;
+        switch (task_state_to_char(thread)) {
+        case 'R': summary->running++; break;
+        case 'S': summary->sleeping++; break;
+        case 'D': summary->blocked++; break;
+        default:  summary->other++; break;
+        }
+        if (thread == task) {
+            continue;
+        }
+        thread_listed = listed && state_wanted(thread, filter);
+        if (!thread_listed && !snap->keys) {
+            continue;
+        }
+        if (*count == capacity) {
+            return -1;
+        }
+        record = (struct task_record_thread *)snapshot_record(snap, *count);
+        fill_record(thread, depth, &record->usage.task);
+        record->usage.utime_ns = utime;
+        record->usage.stime_ns = stime;
+        record->tgid = task->tgid;
+        add_key(snap, *count, thread, thread_listed);
+        (*count)++;
+    }
+    return summary->threads;
+}
+
+static int compare_keys(const void *a, const void *b) {
+    const struct task_key *x = a, *y = b;
+
+    if (x->pid != y->pid) {
+        return x->pid < y->pid ? -1 : 1;
+    }
+    if (x->start_time != y->start_time) {
+        return x->start_time < y->start_time ? -1 : 1;
+    }
+    return 0;
+}
+
+// Copies every task that passes the filters in one RCU pass (and with
+// with_threads, each of its threads).  With with_keys it copies every
+// task, and adds a sorted key per record that says whether the task
+// passed: a delta compares all tasks, so that a task which only changed
+// state (or cgroup) isn't taken for one created or exited.  The walk
+// can't sleep, and
+// can't be picked up again once the RCU read lock is dropped (the task
+// it stopped at may be gone), so the output is built from a copy
+// instead.  Tasks forked between counting and copying get some slack;
+// if even that isn't enough, count again.
+static int take_snapshot(struct task_snapshot *snap, int with_usage, int with_threads,
+                         int with_keys) {
+    size_t record_size = with_threads ? sizeof(struct task_record_thread)
+                         : with_usage ? sizeof(struct task_record_usage)
+                                      : sizeof(struct task_record);
+    u32 flags = (with_usage ? TASK_SNAPSHOT_USAGE : 0) |
+                (with_threads ? TASK_SNAPSHOT_THREADS : 0);
+    struct task_filter filter;
+
+    get_filter(&filter);
+    while (1) {
+        struct task_struct *task;
+        size_t capacity = count_tasks(with_threads) + 64;
+        size_t count = 0, visited = 0;
+        int overflow = 0, max_depth = 0;
+        u64 start;
+
+        if (alloc_snapshot(snap, capacity, record_size, flags) != 0) {
+            return -ENOMEM;
+        }
+        if (with_keys) {
+            snap->keys = vmalloc_array(capacity, sizeof(struct task_key));
+            if (!snap->keys) {
+                free_snapshot(snap);
+                return -ENOMEM;
+            }
+        }
+
+        start = ktime_get_ns();
+        rcu_read_lock();
+        for_each_process(task) {
+            struct task_record *record;
+            int depth = 0, listed, below_root;
+
+            visited++;
+            listed = wanted(task, &filter, with_threads, &depth);
+            if (!listed) {
+                if (!with_keys) {
+                    continue;
+                }
+                depth = task_depth(task, 0, &below_root);
+            }
+            if (count == capacity) {
+                overflow = 1;
+                break;
+            }
+            record = snapshot_record(snap, count);
+            fill_record(task, depth, record);
+            add_key(snap, count, task, listed);
+            if (listed) {
+                max_depth = max(max_depth, depth);
+            }
+            count++;
+            if (with_threads) {
+                // the leader's totals stand in for fill_usage()
+                int seen = add_threads(snap, task, depth, &filter, listed, count - 1,
+                                       &count, capacity);
+
+                if (seen < 0) {
+                    overflow = 1;
+                    break;
+                }
+                visited += seen - 1;
+                if (with_usage) {
+                    fill_rss(task, (struct task_record_usage *)record);
+                }
+            } else if (with_usage) {
+                fill_usage(task, (struct task_record_usage *)record);
+            }
+        }
+        rcu_read_unlock();
+
+        if (!overflow) {
+            snap->header->walk_ns = ktime_get_ns() - start;
+            snap->header->visited = visited;
+            snap->header->max_depth = max_depth;
+            set_count(snap, count);
+            if (with_keys) {
+                sort(snap->keys, count, sizeof(struct task_key), compare_keys, NULL);
+            }
+            return 0;
+        }
+        free_snapshot(snap);
+    }
+}
+
+// Merges the sorted keys of two snapshots: tasks only in now were
+// created, tasks only in old exited.  Only those that passed the
+// filters count (a task that exited is judged by the filters of the
+// snapshot it was last seen in).  With out, copies their records there
+// (created ones first); either way returns how many there are.
+static size_t diff_snapshots(const struct task_snapshot *old, const struct task_snapshot *now,
+                             struct task_snapshot *out, size_t *exited) {
+    size_t old_count = old->header ? old->header->count : 0;
+    size_t now_count = now->header->count;
+    size_t record_size = now->header->record_size;
+    size_t i = 0, j = 0, created = 0;
+    size_t first_exited = out ? out->header->count - out->header->exited : 0;
+
+    *exited = 0;
+    while (i < old_count || j < now_count) {
+        int cmp = (i == old_count) ? 1 : (j == now_count) ? -1
+                  : compare_keys(&old->keys[i], &now->keys[j]);
+
+        if (cmp < 0) {
+            if (!old->keys[i].listed) {
+                i++;
+                continue;
+            }
+            if (out) {
+                memcpy(snapshot_record(out, first_exited + *exited),
+                       snapshot_record(old, old->keys[i].index), record_size);
+            }
+            (*exited)++;
+            i++;
+        } else if (cmp > 0) {
+            if (!now->keys[j].listed) {
+                j++;
+                continue;
+            }
+            if (out) {
+                memcpy(snapshot_record(out, created),
+                       snapshot_record(now, now->keys[j].index), record_size);
+            }
+            created++;
+            j++;
+        } else {
+            i++;
+            j++;
+        }
+    }
+    return created + *exited;
+}
+
+// A delta snapshot against the baseline, which it then replaces.  The
+// first one (or one in a different record format from the baseline)
+// lists every task as created.
+static int take_delta(struct task_snapshot *out, int with_usage, int with_threads) {
+    struct task_snapshot now;
+    size_t changes, exited;
+    int err;
+
+    if (mutex_lock_interruptible(&delta_mutex)) {
+        return -ERESTARTSYS;
+    }
+    err = take_snapshot(&now, with_usage, with_threads, 1);
+    if (err == 0) {
+        if (baseline.header && baseline.header->record_size != now.header->record_size) {
+            free_snapshot(&baseline);
+        }
+        changes = diff_snapshots(&baseline, &now, NULL, &exited);
+        err = alloc_snapshot(out, changes, now.header->record_size,
+                             now.header->flags | TASK_SNAPSHOT_DELTA);
+        if (err == 0) {
+            out->header->taken_ns = now.header->taken_ns;
+            out->header->walk_ns = now.header->walk_ns;
+            out->header->visited = now.header->visited;
+            out->header->max_depth = now.header->max_depth;
+            out->header->generation = ++generation;
+            out->header->exited = exited;
+            set_count(out, changes);
+            diff_snapshots(&baseline, &now, out, &exited);
+            free_snapshot(&baseline);
+            baseline = now;
+        } else {
+            free_snapshot(&now);
+        }
+    }
+    mutex_unlock(&delta_mutex);
+    return err;
+}
+
+// A full or a delta snapshot, of processes or threads, as the
+// parameters say
+static int take_listing(struct task_snapshot *snap, int with_usage) {
+    int with_threads = READ_ONCE(threads);
+
+    if (READ_ONCE(delta)) {
+        return take_delta(snap, with_usage, with_threads);
+    }
+    return take_snapshot(snap, with_usage, with_threads, 0);
+}
+
+// Stands for the last line, after the tasks, like SEQ_START_TOKEN for
+// the first
+#define SEQ_FOOTER_TOKEN ((void *)2)
+
+// The record at pos, or the footer after the last one
+static void *seq_item(struct list_state *state, loff_t pos) {
+    if (!state->snap.header || pos > state->snap.header->count + 1) {
+        return NULL;
+    }
+    if (pos == state->snap.header->count + 1) {
+        return SEQ_FOOTER_TOKEN;
+    }
+    return snapshot_record(&state->snap, pos - 1);
+}
+
+// seq_file calls start() for every page of output.  Reading from the
+// beginning (a new open, or after lseek() to 0) takes a new snapshot;
+// position 0 is the header, task i is at position i + 1, and the footer
+// with the cost of the walk comes last.
+static void *list_tasks_seq_start(struct seq_file *m, loff_t *pos) {
+    struct list_state *state = m->private;
+
+    if (*pos == 0) {
+        int err;
+
+        free_snapshot(&state->snap);
+        err = take_listing(&state->snap, 0);
+        if (err != 0) {
+            return ERR_PTR(err);
+        }
+        return SEQ_START_TOKEN;
+    }
+    return seq_item(state, *pos);
+}
+
+static void *list_tasks_seq_next(struct seq_file *m, void *v, loff_t *pos) {
+    struct list_state *state = m->private;
+
+    ++*pos;
+    return seq_item(state, *pos);
+}
+
+static void list_tasks_seq_stop(struct seq_file *m, void *v) {
+}
+
+// A delta listing starts each line with + for a task created, or - for
+// one that exited
+static int list_tasks_seq_show(struct seq_file *m, void *v) {
+    struct list_state *state = m->private;
+    struct task_snapshot_header *header = state->snap.header;
+    struct task_record *record = v;
+    size_t index;
+
+    if (v == SEQ_START_TOKEN) {
+        if (header->flags & TASK_SNAPSHOT_DELTA) {
+            seq_printf(m, "# generation %llu: %llu created, %llu exited\n+/-\t",
+                       header->generation, header->count - header->exited, header->exited);
+        }
+        if (header->flags & TASK_SNAPSHOT_THREADS) {
+            seq_puts(m, "Command\t\t\tState\tPID\tPPID\tThreads\tR/S/D/other\n");
+        } else {
+            seq_puts(m, "Command\t\t\tState\tPID\tPPID\n");
+        }
+        return 0;
+    }
+    if (v == SEQ_FOOTER_TOKEN) {
+        // same as the DFS module's footer, plus the tasks the filters let through
+        seq_printf(m, "# %u tasks, max depth %u, %llu ns (%llu ns/task), %llu listed\n",
+                   header->visited, header->max_depth, header->walk_ns,
+                   div_u64(header->walk_ns, max(header->visited, 1U)), header->count);
+        return 0;
+    }
+    if (header->flags & TASK_SNAPSHOT_DELTA) {
+        index = ((char *)record - (char *)snapshot_record(&state->snap, 0)) / header->record_size;
+        seq_puts(m, index < header->count - header->exited ? "+\t" : "-\t");
+    }
+    if (header->flags & TASK_SNAPSHOT_THREADS) {
+        struct task_record_thread *thread = v;
+
+        if (thread->threads == 0) {
+            // not the leader: indented under its process, with the process as PPID
+            seq_printf(m, "  %-14s\t%c\t%d\t%d\n", record->comm, record->state,
+                       record->pid, thread->tgid);
+        } else {
+            seq_printf(m, "%-16s\t%c\t%d\t%d\t%u\t%u/%u/%u/%u\n", record->comm,
+                       record->state, record->pid, record->ppid, thread->threads,
+                       thread->running, thread->sleeping, thread->blocked, thread->other);
+        }
+        return 0;
+    }
+    // comm: command name, state: human-readable state character
+    seq_printf(m, "%-16s\t%c\t%d\t%d\n", record->comm, record->state, record->pid,
+               record->ppid);
+    return 0;
+}
+
+static const struct seq_operations list_tasks_seq_ops = {
+    .start = list_tasks_seq_start,
+    .next  = list_tasks_seq_next,
+    .stop  = list_tasks_seq_stop,
+    .show  = list_tasks_seq_show,
+};
+
+static int list_tasks_open(struct inode *inode, struct file *file) {
+    return seq_open_private(file, &list_tasks_seq_ops, sizeof(struct list_state));
+}
+
+static int list_tasks_release(struct inode *inode, struct file *file) {
+    struct seq_file *m = file->private_data;
+    struct list_state *state = m->private;
+
+    free_snapshot(&state->snap);
+    return seq_release_private(inode, file);
+}
+
+static const struct proc_ops list_tasks_proc_ops = {
+    .proc_open    = list_tasks_open,
+    .proc_read    = seq_read,
+    .proc_lseek   = seq_lseek,
+    .proc_release = list_tasks_release,
+};
+
+// The binary file: one snapshot (or delta) per open, taken at open(), to
+// read() in one go or mmap() read-only (see task_record.h for the layout)
+static int list_tasks_bin_open(struct inode *inode, struct file *file) {
+    struct task_snapshot *snap = kzalloc(sizeof(*snap), GFP_KERNEL);
+    int err;
+
+    if (!snap) {
+        return -ENOMEM;
     }
+    err = take_listing(snap, READ_ONCE(usage));
+    if (err != 0) {
+        kfree(snap);
+        return err;
+    }
+    file->private_data = snap;
+    return 0;
+}
+
+static ssize_t list_tasks_bin_read(struct file *file, char __user *buf, size_t count,
+                                   loff_t *ppos) {
+    struct task_snapshot *snap = file->private_data;
+
+    return simple_read_from_buffer(buf, count, ppos, snap->header, snap->size);
+}
+
+static int list_tasks_bin_mmap(struct file *file, struct vm_area_struct *vma) {
+    struct task_snapshot *snap = file->private_data;
+
+    if (vma->vm_flags & VM_WRITE) {
+        return -EPERM;
+    }
+    vm_flags_clear(vma, VM_MAYWRITE); // and no mprotect() to writable later
+    return remap_vmalloc_range(vma, snap->header, vma->vm_pgoff);
+}
 
+static int list_tasks_bin_release(struct inode *inode, struct file *file) {
+    struct task_snapshot *snap = file->private_data;
+
+    free_snapshot(snap);
+    kfree(snap);
+    return 0;
+}
+
+static const struct proc_ops list_tasks_bin_proc_ops = {
+    .proc_open    = list_tasks_bin_open,
+    .proc_read    = list_tasks_bin_read,
+    .proc_mmap    = list_tasks_bin_mmap,
+    .proc_release = list_tasks_bin_release,
+};
+
+static int __init list_tasks_start(void) {
+    if (!proc_create(PROC_NAME, 0444, NULL, &list_tasks_proc_ops)) {
+        return -ENOMEM;
+    }
+    if (!proc_create(BIN_NAME, 0444, NULL, &list_tasks_bin_proc_ops)) {
+        remove_proc_entry(PROC_NAME, NULL);
+        return -ENOMEM;
+    }
+
+    printk(KERN_INFO "Loading list_tasks module: cat /proc/%s, or decode /proc/%s\n",
+           PROC_NAME, BIN_NAME);
     return 0; // A non 0 return means init_module failed; module can't be loaded.
 }
 
 static void __exit list_tasks_end(void) {
+    remove_proc_entry(BIN_NAME, NULL);
+    remove_proc_entry(PROC_NAME, NULL);
+    free_snapshot(&baseline);
     printk(KERN_INFO "Removing list_tasks module...\n");
 }
 
 module_init(list_tasks_start);
 module_exit(list_tasks_end);
-
@@ -0,0 +1,75 @@
+#ifndef task_record_h
+#define task_record_h
+
+// Layout of the binary snapshot read from /proc/list_tasks_bin, shared
+// by the module and the userspace decoder (task_snapshot.c).  A
+// snapshot is a header followed by header.count records, each
+// header.record_size bytes long: a decoder steps by record_size, so
+// later versions can append fields to a record.
+//
+// A delta snapshot (TASK_SNAPSHOT_DELTA) holds only the tasks created
+// since the previous delta snapshot, followed by the last header.exited
+// records: the tasks that exited since then, as they were last seen.
+
+#include <linux/types.h>
+
+#define TASK_SNAPSHOT_MAGIC   0x4b534154 // "TASK" in little-endian
+#define TASK_SNAPSHOT_VERSION 4
+#define TASK_COMM_BYTES       16
+
+// header.flags
+#define TASK_SNAPSHOT_USAGE 0x1 // records are struct task_record_usage
+#define TASK_SNAPSHOT_DELTA 0x2 // changes since the previous delta snapshot
+#define TASK_SNAPSHOT_THREADS 0x4 // records are struct task_record_thread
+
+struct task_snapshot_header {
+    __u32 magic;
+    __u16 version;
+    __u16 header_size;   // records start this many bytes in
+    __u32 record_size;
+    __u32 flags;
+    __u64 count;         // records that follow
+    __u64 taken_ns;      // CLOCK_BOOTTIME when the snapshot was taken
+    __u64 generation;    // delta snapshots are numbered from 1; 0 otherwise
+    __u64 exited;        // records at the end for tasks that exited (delta only)
+    __u64 walk_ns;       // time spent in the walk under the RCU read lock
+    __u32 visited;       // tasks walked past, the ones filtered out included
+    __u32 max_depth;     // deepest task listed
+};
+
+struct task_record {
+    __s32 pid;
+    __s32 ppid;          // tgid of the real parent
+    __u16 depth;         // parent links from init_task (pid 0)
+    __u8  state;         // state character, as in ps
+    __u8  reserved;
+    char  comm[TASK_COMM_BYTES];
+    __u32 reserved2;
+};
+
+// With TASK_SNAPSHOT_USAGE: the above, then resident memory and the CPU
+// time of all the process's threads (the exited ones included)
+struct task_record_usage {
+    struct task_record task;
+    __u64 rss_pages;
+    __u64 utime_ns;
+    __u64 stime_ns;
+};
+
+// With TASK_SNAPSHOT_THREADS: a record per thread, each process's leader
+// first.  The leader's record sums up the process: the CPU time of all
+// its threads (the exited ones included) and its threads by state.  The
+// other threads' records have their own CPU time, and ppid is the real
+// parent of the process.  rss_pages is only filled in for leaders, and
+// only with TASK_SNAPSHOT_USAGE.
+struct task_record_thread {
+    struct task_record_usage usage;
+    __s32 tgid;          // the process (the leader's pid)
+    __u32 threads;       // leader: threads in the process; other threads: 0
+    __u32 running;       // leader: threads in state R,
+    __u32 sleeping;      //                          S,
+    __u32 blocked;       //                          D,
+    __u32 other;         //                          and any other
+};
+
+#endif // task_record_h
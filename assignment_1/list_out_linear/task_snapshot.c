@@ -0,0 +1,275 @@
+// Decoder for the binary task snapshot of the list_tasks module
+// (/proc/list_tasks_bin, laid out as in task_record.h).  Each open of
+// the file takes a new snapshot; this reads it with one read() into a
+// reused buffer, or with -m maps it read-only, checks the header and
+// prints one line per task, like ps.  In the module's threads mode the
+// threads are indented under their process, whose line has the totals;
+// a delta snapshot (its delta mode) marks each task + for created or -
+// for exited.  With -r it instead takes that many snapshots back to back
+// and reports the time per snapshot, decoding included (a state count
+// stands in for the printing), and how much of it the walk itself took,
+// as the module timed it.
+//
+// to compile enter:
+//    cc -Wall -O2 task_snapshot.c
+// usage:
+//    ./a.out [-m] [-r repeats] [file]      (default /proc/list_tasks_bin)
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>   // for SIZE_MAX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "task_record.h"
+
+#define DEFAULT_FILE "/proc/list_tasks_bin"
+
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t mapped;     // bytes to munmap(), 0 if data is the read buffer
+} snapshot_t;
+
+// read() buffer, kept across snapshots
+static char* buffer;
+static size_t capacity;
+
+// Reads the whole file with as few read() calls as the buffer allows
+// (one, once it has grown to fit).  Returns 0, or -1 with a message.
+static int load_read(const char* path, snapshot_t* snap) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Could not open file %s\n", path);
+        return -1;
+    }
+    size_t size = 0;
+    while (1) {
+        if (size == capacity) {
+            size_t bigger = capacity ? 2 * capacity : 1 << 20;
+            char* grown = realloc(buffer, bigger);
+            if (grown == NULL) {
+                printf("Out of memory\n");
+                close(fd);
+                return -1;
+            }
+            buffer = grown;
+            capacity = bigger;
+        }
+        ssize_t got = read(fd, buffer + size, capacity - size);
+        if (got < 0) {
+            printf("Could not read file %s\n", path);
+            close(fd);
+            return -1;
+        }
+        if (got == 0) {
+            break;
+        }
+        size += got;
+    }
+    close(fd);
+    snap->data = buffer;
+    snap->size = size;
+    snap->mapped = 0;
+    return 0;
+}
+
+// Maps the header to learn the size, then the whole snapshot.
+static int load_mmap(const char* path, snapshot_t* snap) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Could not open file %s\n", path);
+        return -1;
+    }
+    void* data = mmap(NULL, page, PROT_READ, MAP_SHARED, fd, 0);
+    size_t size = page;
+    if (data != MAP_FAILED) {
+        // the sizes are only worth trusting in a snapshot (check_header()
+        // checks the rest once it is all mapped)
+        const struct task_snapshot_header* header = data;
+        size_t needed = 0;
+        if (header->magic == TASK_SNAPSHOT_MAGIC && header->record_size > 0 &&
+            header->count <= (SIZE_MAX - header->header_size) / header->record_size) {
+            needed = header->header_size + header->count * header->record_size;
+        }
+        if (needed > page) {
+            munmap(data, page);
+            size = (needed + page - 1) / page * page;
+            data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+    }
+    // a regular file ends before the last mapped page does (a /proc file
+    // has no size)
+    struct stat st;
+    size_t mapped = size;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (size_t)st.st_size < size) {
+        size = st.st_size;
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Could not map file %s\n", path);
+        return -1;
+    }
+    snap->data = data;
+    snap->size = size;
+    snap->mapped = mapped;
+    return 0;
+}
+
+static void unload(snapshot_t* snap) {
+    if (snap->mapped) {
+        munmap((void*)snap->data, snap->mapped);
+    }
+}
+
+// Checks the header against what this decoder knows, and that all the
+// records are there.  Returns the header, or NULL with a message.
+static const struct task_snapshot_header* check_header(const snapshot_t* snap) {
+    const struct task_snapshot_header* header = (const void*)snap->data;
+    if (snap->size < sizeof(*header) || header->magic != TASK_SNAPSHOT_MAGIC) {
+        printf("Not a task snapshot\n");
+        return NULL;
+    }
+    size_t record_size = (header->flags & TASK_SNAPSHOT_THREADS)
+                             ? sizeof(struct task_record_thread)
+                         : (header->flags & TASK_SNAPSHOT_USAGE)
+                             ? sizeof(struct task_record_usage) : sizeof(struct task_record);
+    if (header->version != TASK_SNAPSHOT_VERSION || header->header_size < sizeof(*header) ||
+        header->record_size < record_size) {
+        printf("Snapshot version %u is not supported\n", header->version);
+        return NULL;
+    }
+    if (header->header_size > snap->size ||
+        header->count > (snap->size - header->header_size) / header->record_size) {
+        printf("Snapshot is cut short: %llu records expected\n",
+               (unsigned long long)header->count);
+        return NULL;
+    }
+    if (header->exited > header->count) {
+        printf("Snapshot has more exited tasks than records\n");
+        return NULL;
+    }
+    return header;
+}
+
+static const struct task_record* get_record(const struct task_snapshot_header* header,
+                                            size_t i) {
+    return (const void*)((const char*)header + header->header_size + i * header->record_size);
+}
+
+static void print_tasks(const struct task_snapshot_header* header) {
+    int usage = header->flags & TASK_SNAPSHOT_USAGE;
+    int threads = header->flags & TASK_SNAPSHOT_THREADS;
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    int is_delta = header->flags & TASK_SNAPSHOT_DELTA;
+    size_t created = header->count - header->exited;
+
+    if (is_delta) {
+        printf("generation %llu: %llu created, %llu exited\n",
+               (unsigned long long)header->generation, (unsigned long long)created,
+               (unsigned long long)header->exited);
+        printf("  ");
+    }
+    printf("    PID    PPID S DEPTH    RSS(kB)  USER(s)   SYS(s) COMMAND\n");
+    for (size_t i = 0; i < header->count; i++) {
+        const struct task_record* task = get_record(header, i);
+        if (is_delta) {
+            printf("%c ", i < created ? '+' : '-');
+        }
+        printf("%7d %7d %c %5u ", task->pid, task->ppid, task->state, task->depth);
+        const struct task_record_usage* u = (const void*)task;
+        const struct task_record_thread* t = (const void*)task;
+        int leader = !threads || t->threads > 0;
+        if (usage && leader) {
+            printf("%10llu ", (unsigned long long)u->rss_pages * page_kb);
+        } else {
+            printf("%10s ", "-");
+        }
+        if (usage || threads) {
+            printf("%8.2f %8.2f ", u->utime_ns / 1e9, u->stime_ns / 1e9);
+        } else {
+            printf("%8s %8s ", "-", "-");
+        }
+        if (!leader) {
+            // a thread, under its process
+            printf("  %.*s\n", TASK_COMM_BYTES, task->comm);
+        } else if (threads) {
+            printf("%.*s [%u threads: %u R, %u S, %u D, %u other]\n", TASK_COMM_BYTES,
+                   task->comm, t->threads, t->running, t->sleeping, t->blocked, t->other);
+        } else {
+            printf("%.*s\n", TASK_COMM_BYTES, task->comm);
+        }
+    }
+    printf("# %u tasks, max depth %u, %llu ns (%llu ns/task), %llu listed\n", header->visited,
+           header->max_depth, (unsigned long long)header->walk_ns,
+           (unsigned long long)header->walk_ns / (header->visited ? header->visited : 1),
+           (unsigned long long)header->count);
+}
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int use_mmap = 0, repeats = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "mr:")) != -1) {
+        switch (opt) {
+        case 'm': use_mmap = 1; break;
+        case 'r': repeats = atoi(optarg); break;
+        default:
+            printf("Usage: %s [-m] [-r repeats] [snapshot_file]\n", argv[0]);
+            return 1;
+        }
+    }
+    const char* path = optind < argc ? argv[optind] : DEFAULT_FILE;
+    snapshot_t snap;
+    const struct task_snapshot_header* header;
+
+    if (repeats <= 0) {
+        if ((use_mmap ? load_mmap(path, &snap) : load_read(path, &snap)) != 0) {
+            return 1;
+        }
+        if ((header = check_header(&snap)) == NULL) {
+            return 1;
+        }
+        print_tasks(header);
+        unload(&snap);
+        free(buffer);
+        return 0;
+    }
+
+    long tasks = 0, running = 0;
+    unsigned long long walk_ns = 0;
+    double start = now_sec();
+    for (int k = 0; k < repeats; k++) {
+        if ((use_mmap ? load_mmap(path, &snap) : load_read(path, &snap)) != 0) {
+            return 1;
+        }
+        if ((header = check_header(&snap)) == NULL) {
+            return 1;
+        }
+        for (size_t i = 0; i < header->count; i++) {
+            running += get_record(header, i)->state == 'R';
+        }
+        tasks += header->count;
+        walk_ns += header->walk_ns;
+        unload(&snap);
+    }
+    double elapsed = now_sec() - start;
+    printf("%d snapshots (%s), %.0f tasks each (%.1f running): %.1f us per snapshot, "
+           "%.1f ns per task\n", repeats, use_mmap ? "mmap" : "read", (double)tasks / repeats,
+           (double)running / repeats, elapsed * 1e6 / repeats,
+           tasks ? elapsed * 1e9 / tasks : 0.0);
+    printf("of which the walk in the kernel: %.1f us per snapshot\n", walk_ns / 1e3 / repeats);
+    free(buffer);
+    return 0;
+}
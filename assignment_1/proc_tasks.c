@@ -0,0 +1,457 @@
+// Userspace counterpart of the list_tasks and list_tasks_dfs modules,
+// for machines where they can't be loaded: lists every process from
+// /proc, either in pid order like /proc/list_tasks, or as a depth-first
+// walk of the process tree like /proc/list_tasks_dfs, with the same
+// columns and the same "# tasks, max depth, ns" footer.
+//
+// The pids come from getdents64() on a directory fd for /proc, and each
+// /proc/<pid>/stat is opened with openat() on that fd, so no path is
+// resolved from /.  The stat files are split among threads, which take
+// chunks of pids off a shared counter.  The pid list, the records, the
+// tree and the output are kept in buffers reused across walks.  Unlike
+// the modules this is not one consistent snapshot: a process that exits
+// between listing and reading is left out, and one whose parent is gone
+// by then goes at the top of the tree.  The tree has children in pid
+// order (the kernel keeps them in fork order, which is the same unless
+// pids wrapped around), and starts at the processes whose parent is
+// pid 0, at depth 1, where the module would list init_task itself.
+//
+// With -r it instead walks that many times and reports the time per
+// walk, split into listing, parsing and the tree, then times `ps -eH`
+// (which also prints a tree) as many times for comparison.
+//
+// to compile enter:
+//    cc -Wall -O2 proc_tasks.c -lpthread
+// usage:
+//    ./a.out [-d] [-t threads] [-r repeats]
+//       -d  depth-first tree, like /proc/list_tasks_dfs (default: pid order)
+//       -t  threads to parse the stat files (default: one per CPU)
+//       -r  walks to time, output discarded (default 0: print one)
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define COMM_BYTES   16      // TASK_COMM_LEN, name included NUL
+#define STAT_BYTES   1024    // more than a stat line needs
+#define DIRENT_BYTES (1 << 16)
+#define CHUNK        256     // pids a thread takes at a time
+#define MAX_THREADS  256
+
+typedef struct {
+    int pid, ppid;
+    char state;       // 0 if the process was gone by the time its stat was read
+    char comm[COMM_BYTES];
+} task_t;
+
+// getdents64() records; glibc has no wrapper before 2.30
+typedef struct {
+    unsigned long long d_ino;
+    long long d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+} dirent64_t;
+
+// A task's links in the tree, as indexes into the tasks (-1 for none)
+typedef struct {
+    int first_child;
+    int next_sibling;
+    int parent;           // -1 at the top
+} node_t;
+
+// All the buffers, kept across walks
+typedef struct {
+    int proc_fd;
+    char* dirents;
+    task_t* tasks;
+    int count, capacity;
+    node_t* nodes;        // one per task
+    int node_capacity;
+    char* out;            // the listing
+    size_t out_len, out_capacity;
+    int num_threads;
+    atomic_int next;      // next task to parse
+} walker_t;
+
+typedef struct {
+    double list, parse, tree;    // seconds spent in each step
+    int tasks, max_depth;
+} walk_stats_t;
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int grow(void** buffer, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    int bigger = *capacity ? *capacity : 1024;
+    while (bigger < needed) {
+        bigger *= 2;
+    }
+    void* grown = realloc(*buffer, (size_t)bigger * size);
+    if (grown == NULL) {
+        printf("Out of memory\n");
+        return -1;
+    }
+    *buffer = grown;
+    *capacity = bigger;
+    return 0;
+}
+
+// Fills w->tasks with the pid of every process (the numeric entries of
+// /proc).  Returns 0, or -1 with a message.
+static int list_pids(walker_t* w) {
+    long got;
+
+    w->count = 0;
+    if (lseek(w->proc_fd, 0, SEEK_SET) != 0) {
+        printf("Could not rewind /proc\n");
+        return -1;
+    }
+    while ((got = syscall(SYS_getdents64, w->proc_fd, w->dirents, DIRENT_BYTES)) > 0) {
+        for (long offset = 0; offset < got;) {
+            const dirent64_t* entry = (const dirent64_t*)(w->dirents + offset);
+            offset += entry->d_reclen;
+            if (entry->d_name[0] < '1' || entry->d_name[0] > '9') {
+                continue;
+            }
+            if (grow((void**)&w->tasks, &w->capacity, w->count + 1, sizeof(task_t)) != 0) {
+                return -1;
+            }
+            w->tasks[w->count++].pid = atoi(entry->d_name);
+        }
+    }
+    if (got < 0) {
+        printf("Could not list /proc\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Reads "pid (comm) state ppid ..." from /proc/<pid>/stat.  The command
+// name can hold spaces and parentheses, so it ends at the last ')'.
+static void parse_stat(int proc_fd, task_t* task, char* buffer) {
+    char path[32];
+    snprintf(path, sizeof(path), "%d/stat", task->pid);
+    task->state = 0;
+
+    int fd = openat(proc_fd, path, O_RDONLY);
+    if (fd < 0) {
+        return; // exited since it was listed
+    }
+    ssize_t len = read(fd, buffer, STAT_BYTES - 1);
+    close(fd);
+    if (len <= 0) {
+        return;
+    }
+    buffer[len] = '\0';
+    char* open = strchr(buffer, '(');
+    char* close_paren = strrchr(buffer, ')');
+    if (open == NULL || close_paren == NULL || close_paren < open || close_paren[1] == '\0') {
+        return;
+    }
+    size_t comm_len = close_paren - open - 1;
+    if (comm_len > COMM_BYTES - 1) {
+        comm_len = COMM_BYTES - 1;
+    }
+    memcpy(task->comm, open + 1, comm_len);
+    task->comm[comm_len] = '\0';
+    task->ppid = (int)strtol(close_paren + 4, NULL, 10);
+    task->state = close_paren[2];
+}
+
+static void* parse_worker(void* param) {
+    walker_t* w = param;
+    char buffer[STAT_BYTES];
+    int first;
+
+    while ((first = atomic_fetch_add(&w->next, CHUNK)) < w->count) {
+        int last = first + CHUNK < w->count ? first + CHUNK : w->count;
+        for (int i = first; i < last; i++) {
+            parse_stat(w->proc_fd, &w->tasks[i], buffer);
+        }
+    }
+    return NULL;
+}
+
+// Parses every listed task, split among the threads (this one included).
+static void parse_all(walker_t* w) {
+    pthread_t threads[MAX_THREADS];
+    int started = 0;
+
+    atomic_store(&w->next, 0);
+    for (int i = 1; i < w->num_threads && (long)i * CHUNK < w->count; i++) {
+        if (pthread_create(&threads[started], NULL, parse_worker, w) != 0) {
+            break; // fewer threads: the rest still gets parsed
+        }
+        started++;
+    }
+    parse_worker(w);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static int compare_pids(const void* a, const void* b) {
+    const task_t* x = a;
+    const task_t* y = b;
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+// Index of the task with the pid in the sorted tasks, or -1
+static int find_task(const walker_t* w, int pid) {
+    int low = 0, high = w->count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (w->tasks[mid].pid == pid) {
+            return mid;
+        }
+        if (w->tasks[mid].pid < pid) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+// Links every task to its parent.  Going through the tasks backwards and
+// pushing each on the front of its parent's list leaves the children in
+// pid order.  Tasks gone before their stat was read are dropped first.
+static int build_tree(walker_t* w) {
+    int kept = 0;
+    for (int i = 0; i < w->count; i++) {
+        if (w->tasks[i].state) {
+            w->tasks[kept++] = w->tasks[i];
+        }
+    }
+    w->count = kept;
+    // /proc lists pids in order, but nothing promises it
+    qsort(w->tasks, w->count, sizeof(task_t), compare_pids);
+
+    if (grow((void**)&w->nodes, &w->node_capacity, w->count, sizeof(node_t)) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < w->count; i++) {
+        w->nodes[i].first_child = -1;
+        w->nodes[i].next_sibling = -1;
+    }
+    for (int i = w->count - 1; i >= 0; i--) {
+        int parent = w->tasks[i].ppid ? find_task(w, w->tasks[i].ppid) : -1;
+        w->nodes[i].parent = parent;
+        if (parent >= 0) {
+            w->nodes[i].next_sibling = w->nodes[parent].first_child;
+            w->nodes[parent].first_child = i;
+        }
+    }
+    return 0;
+}
+
+// printf()s to the end of the output buffer, growing it as needed
+static int append(walker_t* w, const char* format, ...) {
+    while (1) {
+        va_list args;
+        va_start(args, format);
+        size_t room = w->out_capacity - w->out_len;
+        int len = vsnprintf(w->out + w->out_len, room, format, args);
+        va_end(args);
+        if (len < 0) {
+            return -1;
+        }
+        if ((size_t)len < room) {
+            w->out_len += len;
+            return 0;
+        }
+        size_t bigger = w->out_capacity ? 2 * w->out_capacity : 1 << 20;
+        char* grown = realloc(w->out, bigger);
+        if (grown == NULL) {
+            printf("Out of memory\n");
+            return -1;
+        }
+        w->out = grown;
+        w->out_capacity = bigger;
+    }
+}
+
+// The depth of each task comes from following its parent links up, as
+// in the linear module
+static void output_linear(walker_t* w, walk_stats_t* stats) {
+    append(w, "Command\t\t\tState\tPID\tPPID\n");
+    stats->max_depth = 0;
+    for (int i = 0; i < w->count; i++) {
+        const task_t* task = &w->tasks[i];
+        append(w, "%-16s\t%c\t%d\t%d\n", task->comm, task->state, task->pid, task->ppid);
+        int depth = 1;
+        for (int up = w->nodes[i].parent; up >= 0 && depth <= w->count; up = w->nodes[up].parent) {
+            depth++;
+        }
+        if (depth > stats->max_depth) {
+            stats->max_depth = depth;
+        }
+    }
+}
+
+// Depth-first from each task at the top, without recursion, as in the
+// DFS module: down to the first child, or else back up the parent links
+// to the nearest ancestor with a next sibling.
+static void output_dfs(walker_t* w, walk_stats_t* stats) {
+    append(w, "Command\t\t\tState\tPID\tDepth\n");
+    stats->max_depth = 0;
+    for (int top = 0; top < w->count; top++) {
+        if (w->nodes[top].parent >= 0) {
+            continue;
+        }
+        int i = top, depth = 1;
+        while (1) {
+            const task_t* task = &w->tasks[i];
+            append(w, "%-16s\t%c\t%d\t%d\n", task->comm, task->state, task->pid, depth);
+            if (depth > stats->max_depth) {
+                stats->max_depth = depth;
+            }
+            if (w->nodes[i].first_child >= 0) {
+                i = w->nodes[i].first_child;
+                depth++;
+                continue;
+            }
+            while (i != top && w->nodes[i].next_sibling < 0) {
+                i = w->nodes[i].parent;
+                depth--;
+            }
+            if (i == top) {
+                break;
+            }
+            i = w->nodes[i].next_sibling;
+        }
+    }
+}
+
+// One whole walk, its listing left in w->out.  Returns 0 or -1.
+static int walk(walker_t* w, int dfs, walk_stats_t* stats) {
+    double start = now_sec();
+    if (list_pids(w) != 0) {
+        return -1;
+    }
+    double listed = now_sec();
+    parse_all(w);
+    double parsed = now_sec();
+    if (build_tree(w) != 0) {
+        return -1;
+    }
+    w->out_len = 0;
+    if (dfs) {
+        output_dfs(w, stats);
+    } else {
+        output_linear(w, stats);
+    }
+    double done = now_sec();
+
+    stats->list = listed - start;
+    stats->parse = parsed - listed;
+    stats->tree = done - parsed;
+    stats->tasks = w->count;
+    long long ns = (long long)((done - start) * 1e9);
+    return append(w, "# %d tasks, max depth %d, %lld ns (%lld ns/task)\n", w->count,
+                  stats->max_depth, ns, w->count ? ns / w->count : 0);
+}
+
+// Runs `ps -eH` repeats times, its output read and thrown away.
+// Returns the seconds per run, or -1.
+static double time_ps(int repeats, int* lines) {
+    char line[4096];
+    double start = now_sec();
+    for (int k = 0; k < repeats; k++) {
+        FILE* ps = popen("ps -eH", "r");
+        if (ps == NULL) {
+            return -1;
+        }
+        *lines = 0;
+        while (fgets(line, sizeof(line), ps) != NULL) {
+            (*lines)++;
+        }
+        if (pclose(ps) != 0) {
+            return -1;
+        }
+    }
+    return (now_sec() - start) / repeats;
+}
+
+int main(int argc, char* argv[]) {
+    walker_t w = {0};
+    int dfs = 0, repeats = 0;
+    int opt;
+
+    w.num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    while ((opt = getopt(argc, argv, "dt:r:")) != -1) {
+        switch (opt) {
+        case 'd': dfs = 1; break;
+        case 't': w.num_threads = atoi(optarg); break;
+        case 'r': repeats = atoi(optarg); break;
+        default:
+            printf("Usage: %s [-d] [-t threads] [-r repeats]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (w.num_threads < 1 || w.num_threads > MAX_THREADS) {
+        printf("Threads must be between 1 and %d\n", MAX_THREADS);
+        return 1;
+    }
+    w.proc_fd = open("/proc", O_RDONLY | O_DIRECTORY);
+    w.dirents = malloc(DIRENT_BYTES);
+    if (w.proc_fd < 0 || w.dirents == NULL) {
+        printf("Could not open /proc\n");
+        return 1;
+    }
+
+    walk_stats_t stats;
+    if (repeats <= 0) {
+        if (walk(&w, dfs, &stats) != 0) {
+            return 1;
+        }
+        fwrite(w.out, 1, w.out_len, stdout);
+    } else {
+        walk_stats_t total = {0};
+        for (int k = 0; k < repeats; k++) {
+            if (walk(&w, dfs, &stats) != 0) {
+                return 1;
+            }
+            total.list += stats.list;
+            total.parse += stats.parse;
+            total.tree += stats.tree;
+        }
+        double per_walk = (total.list + total.parse + total.tree) / repeats;
+        printf("%d walks (%s, %d threads), %d tasks: %.2f ms per walk "
+               "(list %.2f, parse %.2f, %s %.2f), %.0f ns per task\n", repeats,
+               dfs ? "tree" : "pid order", w.num_threads, stats.tasks, per_walk * 1e3,
+               total.list * 1e3 / repeats, total.parse * 1e3 / repeats,
+               dfs ? "tree" : "output", total.tree * 1e3 / repeats,
+               stats.tasks ? per_walk * 1e9 / stats.tasks : 0.0);
+        int lines = 0;
+        double ps = time_ps(repeats, &lines);
+        if (ps < 0) {
+            printf("Could not run ps -eH\n");
+        } else {
+            printf("ps -eH: %.2f ms per run (%d lines), %.1fx the time of a walk\n", ps * 1e3,
+                   lines, ps / per_walk);
+        }
+    }
+
+    close(w.proc_fd);
+    free(w.dirents);
+    free(w.tasks);
+    free(w.nodes);
+    free(w.out);
+    return 0;
+}
@@ -1,7 +1,13 @@
+// to compile enter:
+//    cc -Wall -I../../common thread1.c ../../common/thread_launch.c -lpthread
+// threads are placed on CPUs as THREAD_PLACEMENT says (see thread_launch.h)
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
 
+#include "thread_launch.h"
+
 void *print_message_function( void *ptr );
 
 int main()
@@ -13,14 +19,14 @@ int main()
 
     /* Create independent threads each of which will execute function */
 
-     iret1 = pthread_create( &thread1, NULL, print_message_function, (void*) message1);
+     iret1 = thread_launch( &thread1, 0, print_message_function, (void*) message1);
      if(iret1)
      {
          fprintf(stderr,"Error - pthread_create() return code: %d\n",iret1);
          exit(EXIT_FAILURE);
      }
 
-     iret2 = pthread_create( &thread2, NULL, print_message_function, (void*) message2);
+     iret2 = thread_launch( &thread2, 1, print_message_function, (void*) message2);
      if(iret2)
      {
          fprintf(stderr,"Error - pthread_create() return code: %d\n",iret2);
@@ -45,4 +51,5 @@ void *print_message_function( void *ptr )
      char *message;
      message = (char *) ptr;
      printf("%s \n", message);
+     return NULL;
 }
@@ -0,0 +1,165 @@
+// Micro-benchmark of the sudoku validation kernels: the per-region
+// functions (check_grid), the one-pass bitmask kernel, the SSSE3 kernel
+// and the batched kernel (two grids per pass with AVX2).  All kernels
+// are first cross-checked against each other (and sudoku_diagnose())
+// on every grid.  Also times sudoku_diagnose() itself, and the input
+// parser on both file formats.
+//
+// to compile enter (-march=native turns on the SIMD kernels):
+//    cc -Wall -O2 -march=native -I../common sudoku_bench.c sudoku_corpus.c sudoku_check.c sudoku_parse.c ../common/rng.c
+// usage:
+//    ./a.out [num_grids] [repeats]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sudoku_check.h"
+#include "sudoku_corpus.h"
+#include "sudoku_parse.h"
+
+#define START_SEED 11 // arbitrary value to seed random number generator
+
+// Every other grid is valid; the rest get one cell changed to a random
+// value in 0-10 (which may happen to leave them valid).
+static sudoku_grid_t* make_grids(int n) {
+    rng_t rng;
+    sudoku_grid_t* grids = malloc(n * sizeof(sudoku_grid_t));
+
+    rng_seed(&rng, START_SEED);
+    for (int i = 0; i < n; i++) {
+        corpus_valid_grid(&rng, &grids[i]);
+        if (i & 1) {
+            grids[i].cell[rng_below(&rng, PUZZLE_CELLS)] = (unsigned char)rng_below(&rng, 11);
+        }
+    }
+    return grids;
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef int (*kernel_t)(const sudoku_grid_t*);
+
+static int diagnose(const sudoku_grid_t* grid) {
+    sudoku_diag_t diag;
+    return sudoku_diagnose(grid, &diag);
+}
+
+static void bench_kernel(const char* name, kernel_t kernel,
+                         const sudoku_grid_t* grids, int n, int repeats) {
+    volatile long sink = 0;
+    double start = now_ns();
+    for (int k = 0; k < repeats; k++) {
+        long valid = 0;
+        for (int i = 0; i < n; i++) {
+            valid += kernel(&grids[i]);
+        }
+        sink += valid;
+    }
+    double ns = (now_ns() - start) / ((double)n * repeats);
+    printf("%-12s | %10.1f | %14.0f\n", name, ns, 1e9 / ns);
+}
+
+static void bench_batched(const sudoku_grid_t* grids, unsigned char* valid,
+                          int n, int repeats) {
+    double start = now_ns();
+    for (int k = 0; k < repeats; k++) {
+        check_grids(grids, valid, n);
+    }
+    double ns = (now_ns() - start) / ((double)n * repeats);
+    printf("%-12s | %10.1f | %14.0f\n", "batched", ns, 1e9 / ns);
+}
+
+// Writes the grids out as text, either one 81 character line per grid
+// or as 9 lines of space separated numbers (like correct_sudoku).
+static char* format_grids(const sudoku_grid_t* grids, int n, int one_line, size_t* size) {
+    char* text = malloc((size_t)n * (2 * PUZZLE_CELLS + 1));
+    char* p = text;
+    for (int i = 0; i < n; i++) {
+        for (int c = 0; c < PUZZLE_CELLS; c++) {
+            int v = grids[i].cell[c];
+            if (v > 9) { // "10" doesn't fit in one character
+                v = 0;
+            }
+            *p++ = '0' + v;
+            if (!one_line) {
+                *p++ = (c % PUZZLE_SIZE == PUZZLE_SIZE - 1) ? '\n' : ' ';
+            }
+        }
+        *p++ = '\n';
+    }
+    *size = p - text;
+    return text;
+}
+
+static void bench_parser(const char* name, const sudoku_grid_t* grids, int n,
+                         int one_line, int repeats) {
+    size_t size;
+    char* text = format_grids(grids, n, one_line, &size);
+    sudoku_grid_t grid;
+    long parsed = 0;
+
+    double start = now_ns();
+    for (int k = 0; k < repeats; k++) {
+        sudoku_parser_t parser;
+        parser_init_buffer(&parser, text, size);
+        while (parser_next(&parser, &grid) > 0) {
+            parsed++;
+        }
+    }
+    double ns = now_ns() - start;
+    if (parsed != (long)n * repeats) {
+        printf("parser lost grids: %ld of %ld\n", parsed, (long)n * repeats);
+        exit(1);
+    }
+    printf("%-12s | %10.1f | %14.0f | %8.0f MB/s\n", name, ns / parsed,
+           1e9 * parsed / ns, size * (double)repeats * 1e3 / ns);
+    free(text);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int repeats = argc > 2 ? atoi(argv[2]) : 20;
+    if (n < 1 || repeats < 1) {
+        printf("Usage: %s [num_grids] [repeats]\n", argv[0]);
+        return 1;
+    }
+
+    sudoku_grid_t* grids = make_grids(n);
+    unsigned char* valid = malloc(n);
+
+    // every kernel must agree with the per-region functions
+    check_grids(grids, valid, n);
+    long num_valid = 0;
+    for (int i = 0; i < n; i++) {
+        int expect = check_grid(&grids[i]);
+        num_valid += expect;
+        if (check_grid_masks(&grids[i]) != expect ||
+            check_grid_simd(&grids[i]) != expect || valid[i] != expect ||
+            diagnose(&grids[i]) != expect) {
+            printf("kernels disagree on grid %d\n", i);
+            return 1;
+        }
+    }
+    printf("%d grids (%ld valid), %d repeats\n", n, num_valid, repeats);
+
+    printf("Kernel       | ns/grid    | grids/sec\n");
+    bench_kernel("per-region", check_grid, grids, n, repeats);
+    bench_kernel("bitmask", check_grid_masks, grids, n, repeats);
+    bench_kernel("simd", check_grid_simd, grids, n, repeats);
+    bench_batched(grids, valid, n, repeats);
+    bench_kernel("diagnose", diagnose, grids, n, repeats);
+
+    printf("\nParser       | ns/grid    | grids/sec      | throughput\n");
+    bench_parser("one-line", grids, n, 1, repeats);
+    bench_parser("numbers", grids, n, 0, repeats);
+
+    free(valid);
+    free(grids);
+    return 0;
+}
@@ -0,0 +1,232 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sudoku_big.h"
+
+#define PARALLEL_MIN_ORDER 16 // smaller grids are checked on one thread
+
+int big_grid_init(big_grid_t* grid, int order) {
+    if (order < 2 || order > BIG_MAX_ORDER) {
+        return -1;
+    }
+    grid->order = order;
+    grid->size = order * order;
+    grid->cell = calloc((size_t)grid->size * grid->size, sizeof(uint16_t));
+    return grid->cell != NULL ? 0 : -1;
+}
+
+void big_grid_free(big_grid_t* grid) {
+    free(grid->cell);
+    grid->cell = NULL;
+}
+
+// Kernel for grids of up to 25 digits, where every digit mask fits in
+// 32 bits.  It is inlined with a constant order below, so the compiler
+// unrolls the loops and turns the divisions into constants.  As in
+// check_grid_masks(), a unit whose masks OR to all digits holds each
+// exactly once, and out of range cells contribute no bit.
+static inline __attribute__((always_inline))
+int check_small(const uint16_t* cell, int order) {
+    const int size = order * order;
+    const uint32_t full = (1u << size) - 1;
+    uint32_t cols[25] = {0};
+    uint32_t all = full; // AND of every row, column and box mask
+
+    for (int band = 0; band < size; band += order) {
+        uint32_t boxes[5] = {0};
+        for (int row = band; row < band + order; row++) {
+            uint32_t mask = 0;
+            for (int col = 0; col < size; col++) {
+                unsigned value = cell[row * size + col];
+                uint32_t bit = (value - 1u < (unsigned)size) ? 1u << (value - 1) : 0;
+                mask |= bit;
+                cols[col] |= bit;
+                boxes[col / order] |= bit;
+            }
+            all &= mask;
+        }
+        for (int b = 0; b < order; b++) {
+            all &= boxes[b];
+        }
+    }
+    for (int col = 0; col < size; col++) {
+        all &= cols[col];
+    }
+    return all == full;
+}
+
+static int check_order2(const uint16_t* cell) { return check_small(cell, 2); }
+static int check_order3(const uint16_t* cell) { return check_small(cell, 3); }
+static int check_order4(const uint16_t* cell) { return check_small(cell, 4); }
+static int check_order5(const uint16_t* cell) { return check_small(cell, 5); }
+
+// Generic kernel: digit sets of "words" 64-bit words each.
+
+static inline int set_words(const big_grid_t* grid) {
+    return (grid->size + 63) / 64;
+}
+
+static int set_full(const uint64_t* set, int size) {
+    int words = (size + 63) / 64;
+    for (int w = 0; w < words - 1; w++) {
+        if (set[w] != ~(uint64_t)0) {
+            return 0;
+        }
+    }
+    uint64_t last = (size % 64) ? ((uint64_t)1 << (size % 64)) - 1 : ~(uint64_t)0;
+    return set[words - 1] == last;
+}
+
+// Checks the rows and boxes of bands [first, last) and ORs the digits
+// of each column into cols (size sets), whose test is left to the
+// caller.  scratch holds order + 1 sets.  Stops early once *failed is
+// set by another thread.
+static int check_bands(const big_grid_t* grid, int first, int last, uint64_t* cols,
+                       uint64_t* scratch, atomic_int* failed) {
+    const int order = grid->order, size = grid->size;
+    const int words = set_words(grid);
+    uint64_t* row_set = scratch;
+    uint64_t* box_set = scratch + words;
+
+    for (int band = first; band < last; band++) {
+        if (failed != NULL && atomic_load_explicit(failed, memory_order_relaxed)) {
+            return 0;
+        }
+        memset(box_set, 0, (size_t)order * words * sizeof(uint64_t));
+        for (int row = band * order; row < (band + 1) * order; row++) {
+            const uint16_t* cell = &BIG_AT(grid, row, 0);
+            memset(row_set, 0, words * sizeof(uint64_t));
+            for (int col = 0; col < size; col++) {
+                unsigned digit = cell[col] - 1u;
+                if (digit >= (unsigned)size) {
+                    return 0; // empty or out of range
+                }
+                uint64_t bit = (uint64_t)1 << (digit % 64);
+                row_set[digit / 64] |= bit;
+                box_set[(col / order) * words + digit / 64] |= bit;
+                cols[(size_t)col * words + digit / 64] |= bit;
+            }
+            if (!set_full(row_set, size)) {
+                return 0;
+            }
+        }
+        for (int b = 0; b < order; b++) {
+            if (!set_full(&box_set[b * words], size)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static int cols_full(const big_grid_t* grid, const uint64_t* cols) {
+    const int words = set_words(grid);
+    for (int col = 0; col < grid->size; col++) {
+        if (!set_full(&cols[(size_t)col * words], grid->size)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int check_generic(const big_grid_t* grid) {
+    const int words = set_words(grid);
+    uint64_t* cols = calloc((size_t)(grid->size + grid->order + 1) * words, sizeof(uint64_t));
+    if (cols == NULL) {
+        return 0;
+    }
+    int valid = check_bands(grid, 0, grid->order, cols,
+                            cols + (size_t)grid->size * words, NULL) &&
+                cols_full(grid, cols);
+    free(cols);
+    return valid;
+}
+
+int check_big_grid(const big_grid_t* grid) {
+    switch (grid->order) {
+    case 2: return check_order2(grid->cell);
+    case 3: return check_order3(grid->cell);
+    case 4: return check_order4(grid->cell);
+    case 5: return check_order5(grid->cell);
+    default: return check_generic(grid);
+    }
+}
+
+typedef struct {
+    const big_grid_t* grid;
+    int first, last;  // bands to check
+    uint64_t* cols;   // this thread's column sets, then its scratch
+    atomic_int* failed;
+} band_work_t;
+
+static void* band_worker(void* param) {
+    band_work_t* work = (band_work_t*)param;
+    const big_grid_t* grid = work->grid;
+    uint64_t* scratch = work->cols + (size_t)grid->size * set_words(grid);
+
+    if (!check_bands(grid, work->first, work->last, work->cols, scratch, work->failed)) {
+        atomic_store(work->failed, 1);
+    }
+    return NULL;
+}
+
+int check_big_grid_parallel(const big_grid_t* grid, int num_threads) {
+    if (num_threads > grid->order) {
+        num_threads = grid->order;
+    }
+    if (num_threads <= 1 || grid->order < PARALLEL_MIN_ORDER) {
+        return check_big_grid(grid);
+    }
+
+    // Each thread checks the rows and boxes of its bands, and collects
+    // partial column sets; a column is valid when the OR of its parts
+    // is full, which is tested here once every thread is done.
+    const int words = set_words(grid);
+    const size_t per_thread = (size_t)(grid->size + grid->order + 1) * words;
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    band_work_t* work = malloc(num_threads * sizeof(band_work_t));
+    uint64_t* sets = calloc(per_thread * num_threads, sizeof(uint64_t));
+    atomic_int failed = 0;
+    int valid = 0;
+
+    if (threads == NULL || work == NULL || sets == NULL) {
+        free(sets);
+        free(work);
+        free(threads);
+        return 0;
+    }
+    for (int t = 0; t < num_threads; t++) {
+        work[t].grid = grid;
+        work[t].first = grid->order * t / num_threads;
+        work[t].last = grid->order * (t + 1) / num_threads;
+        work[t].cols = sets + per_thread * t;
+        work[t].failed = &failed;
+    }
+    // bands without a thread (pthread_create() failed) are checked here
+    int started = 0;
+    for (int t = 0; t < num_threads; t++) {
+        if (pthread_create(&threads[started], NULL, band_worker, &work[t]) == 0) {
+            started++;
+        } else {
+            band_worker(&work[t]);
+        }
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    if (!failed) {
+        for (int t = 1; t < num_threads; t++) {
+            for (size_t w = 0; w < (size_t)grid->size * words; w++) {
+                sets[w] |= work[t].cols[w];
+            }
+        }
+        valid = cols_full(grid, sets);
+    }
+    free(sets);
+    free(work);
+    free(threads);
+    return valid;
+}
@@ -0,0 +1,35 @@
+#ifndef sudoku_big_h
+#define sudoku_big_h
+
+#include <stdint.h>
+
+#define BIG_MAX_ORDER 255 // largest box side; digits must fit in 16 bits
+
+// An N^2 x N^2 grid of box order N (N = 3 is the usual 9x9 sudoku, 4
+// gives 16x16, 5 gives 25x25, ...), one 16-bit cell per square, row by
+// row.  A valid solution holds each of the digits 1 to N^2 exactly once
+// in every row, column and N x N box.
+typedef struct {
+    int order;       // box side N
+    int size;        // N^2: digits, and cells per row, column and box
+    uint16_t* cell;  // size * size cells
+} big_grid_t;
+
+#define BIG_AT(g, row, col) ((g)->cell[(size_t)(row) * (g)->size + (col)])
+
+// Allocates a grid of all empty (0) cells.  Returns 0, or -1 if the
+// order is out of range or there is no memory.
+int big_grid_init(big_grid_t* grid, int order);
+void big_grid_free(big_grid_t* grid);
+
+// Returns 1 if the grid is a valid solution, 0 otherwise.  Orders 2-5
+// use kernels specialized at compile time; larger grids go through a
+// generic kernel with one bitset per row, column and box.
+int check_big_grid(const big_grid_t* grid);
+
+// The same check split across up to num_threads threads, each taking
+// whole bands of boxes.  Small grids aren't worth the threads and are
+// checked on the calling thread.
+int check_big_grid_parallel(const big_grid_t* grid, int num_threads);
+
+#endif // sudoku_big_h
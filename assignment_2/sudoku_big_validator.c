@@ -0,0 +1,163 @@
+// Validator for N^2 x N^2 grids (16x16, 25x25 and larger).  Reads one
+// grid of whitespace separated numbers; its order follows from the
+// count of numbers (N^4).  With -g it instead builds a valid grid of
+// the given order and times the single-threaded and parallel checks,
+// on that grid and on copies with a broken column and a bad cell.
+//
+// to compile enter:
+//    cc -Wall -O2 sudoku_big_validator.c sudoku_big.c -lpthread
+// usage:
+//    ./a.out [-t threads] <sudoku_puzzle_file>
+//    ./a.out [-t threads] -g order [repeats]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sudoku_big.h"
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Reads every number in the file into a grid.  Returns 0, or -1 with a
+// message printed.
+static int read_big_grid(const char* path, big_grid_t* grid) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Could not open file %s\n", path);
+        return -1;
+    }
+    size_t count = 0, capacity = 1024;
+    long* nums = malloc(capacity * sizeof(long));
+    long num;
+    while (nums != NULL && fscanf(file, "%ld", &num) == 1) {
+        if (count == capacity) {
+            long* bigger = realloc(nums, (capacity *= 2) * sizeof(long));
+            if (bigger == NULL) {
+                break;
+            }
+            nums = bigger;
+        }
+        nums[count++] = num;
+    }
+    int malformed = !feof(file);
+    fclose(file);
+
+    int order = 2;
+    while (order < BIG_MAX_ORDER && (size_t)order * order * order * order < count) {
+        order++;
+    }
+    if (nums == NULL || malformed || (size_t)order * order * order * order != count) {
+        printf("Expected N^4 numbers for a grid of order N, found %zu%s\n", count,
+               malformed ? " before malformed input" : "");
+        free(nums);
+        return -1;
+    }
+    if (big_grid_init(grid, order) != 0) {
+        printf("Out of memory\n");
+        free(nums);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        grid->cell[i] = (nums[i] < 0 || nums[i] > 0xffff) ? 0 : nums[i];
+    }
+    free(nums);
+    return 0;
+}
+
+// A valid grid: row r is the digits shifted by (r % N) * N + r / N.
+static void make_valid(big_grid_t* grid) {
+    for (int r = 0; r < grid->size; r++) {
+        int shift = (r % grid->order) * grid->order + r / grid->order;
+        for (int c = 0; c < grid->size; c++) {
+            BIG_AT(grid, r, c) = (shift + c) % grid->size + 1;
+        }
+    }
+}
+
+static void bench(const char* name, const big_grid_t* grid, int threads, int repeats) {
+    int single = 0, parallel = 0;
+
+    double start = now_sec();
+    for (int k = 0; k < repeats; k++) {
+        single += check_big_grid(grid);
+    }
+    double t1 = (now_sec() - start) / repeats;
+
+    start = now_sec();
+    for (int k = 0; k < repeats; k++) {
+        parallel += check_big_grid_parallel(grid, threads);
+    }
+    double tn = (now_sec() - start) / repeats;
+
+    if (single != parallel) {
+        printf("single-threaded and parallel checks disagree on %s grid\n", name);
+        exit(1);
+    }
+    printf("%-12s | %-9s | %12.1f | %12.1f | %7.2fx\n", name,
+           single ? "valid" : "not valid", t1 * 1e6, tn * 1e6, t1 / tn);
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int order = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:g:")) != -1) {
+        switch (opt) {
+        case 't': num_threads = atoi(optarg); break;
+        case 'g': order = atoi(optarg); break;
+        default:
+            printf("Usage: %s [-t threads] <sudoku_puzzle_file>\n"
+                   "       %s [-t threads] -g order [repeats]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    big_grid_t grid;
+    if (order == 0) {
+        if (optind >= argc) {
+            printf("Usage: %s [-t threads] <sudoku_puzzle_file>\n", argv[0]);
+            return 1;
+        }
+        if (read_big_grid(argv[optind], &grid) != 0) {
+            return 1;
+        }
+        int valid = check_big_grid_parallel(&grid, num_threads);
+        printf("%dx%d: %s\n", grid.size, grid.size, valid ? "valid" : "not valid");
+        big_grid_free(&grid);
+        return 0;
+    }
+
+    int repeats = optind < argc ? atoi(argv[optind]) : 10;
+    if (repeats < 1 || big_grid_init(&grid, order) != 0) {
+        printf("Order must be 2-%d, and repeats positive\n", BIG_MAX_ORDER);
+        return 1;
+    }
+    make_valid(&grid);
+    printf("%dx%d grid, %d threads, %d repeats\n", grid.size, grid.size,
+           num_threads, repeats);
+    printf("Grid         | Result    | 1 thread us  | parallel us  | speedup\n");
+    bench("valid", &grid, num_threads, repeats);
+
+    // swapping two cells of the last row keeps every row valid but
+    // breaks two columns (and maybe a box), found only at the very end
+    int last = grid.size - 1;
+    uint16_t t = BIG_AT(&grid, last, 0);
+    BIG_AT(&grid, last, 0) = BIG_AT(&grid, last, last);
+    BIG_AT(&grid, last, last) = t;
+    bench("swapped", &grid, num_threads, repeats);
+    BIG_AT(&grid, last, last) = BIG_AT(&grid, last, 0);
+    BIG_AT(&grid, last, 0) = t;
+
+    BIG_AT(&grid, grid.size / 2, grid.size / 2) = 0;
+    bench("empty cell", &grid, num_threads, repeats);
+
+    big_grid_free(&grid);
+    return 0;
+}
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "sudoku_check.h"
+
+// Validates a single row
+int check_row(const sudoku_grid_t* grid, int row) {
+    int flag[PUZZLE_SIZE + 1] = {0}; // Tracker for digits 1-9
+
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        int num = GRID_AT(grid, row, i);
+        if (num < 1 || num > PUZZLE_SIZE || flag[num] == 1) {
+            return 0; // Duplicate or not a digit
+        }
+        flag[num] = 1;
+    }
+    return 1;
+}
+
+// Validates a single column
+int check_col(const sudoku_grid_t* grid, int col) {
+    int flag[PUZZLE_SIZE + 1] = {0};
+
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        int num = GRID_AT(grid, i, col);
+        if (num < 1 || num > PUZZLE_SIZE || flag[num] == 1) {
+            return 0;
+        }
+        flag[num] = 1;
+    }
+    return 1;
+}
+
+// Validates a single 3x3 subgrid
+int check_subgrid(const sudoku_grid_t* grid, int rowStart, int colStart) {
+    int flag[PUZZLE_SIZE + 1] = {0};
+
+    for (int i = rowStart; i < rowStart + 3; i++) {
+        for (int j = colStart; j < colStart + 3; j++) {
+            int num = GRID_AT(grid, i, j);
+            if (num < 1 || num > PUZZLE_SIZE || flag[num] == 1) {
+                return 0;
+            }
+            flag[num] = 1;
+        }
+    }
+    return 1;
+}
+
+int check_grid(const sudoku_grid_t* grid) {
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        if (!check_row(grid, i) || !check_col(grid, i)) {
+            return 0;
+        }
+    }
+    for (int i = 0; i < PUZZLE_SIZE; i += 3) {
+        for (int j = 0; j < PUZZLE_SIZE; j += 3) {
+            if (!check_subgrid(grid, i, j)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Digit mask of each cell value: bit d-1 for the digits d = 1-9, and no
+// bit at all for anything else, so such a cell can never complete the
+// nine digits of its row, column or box.
+static const unsigned short digit_bit[256] = {
+    0, 1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7, 1 << 8,
+};
+
+int check_grid_masks(const sudoku_grid_t* grid) {
+    unsigned cols[PUZZLE_SIZE] = {0};
+    unsigned all = 0x1ff; // AND of every row, column and box mask
+
+    // Nine cells whose masks OR together to all nine digits must hold
+    // each digit exactly once, so no per-cell duplicate test is needed.
+    for (int band = 0; band < PUZZLE_SIZE; band += 3) {
+        unsigned box0 = 0, box1 = 0, box2 = 0;
+        for (int row = band; row < band + 3; row++) {
+            const unsigned char* cell = &grid->cell[row * PUZZLE_SIZE];
+            unsigned bit[PUZZLE_SIZE];
+            for (int i = 0; i < PUZZLE_SIZE; i++) {
+                bit[i] = digit_bit[cell[i]];
+                cols[i] |= bit[i];
+            }
+            box0 |= bit[0] | bit[1] | bit[2];
+            box1 |= bit[3] | bit[4] | bit[5];
+            box2 |= bit[6] | bit[7] | bit[8];
+            all &= bit[0] | bit[1] | bit[2] | bit[3] | bit[4] |
+                   bit[5] | bit[6] | bit[7] | bit[8];
+        }
+        all &= box0 & box1 & box2;
+    }
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        all &= cols[i];
+    }
+    return all == 0x1ff;
+}
+
+#if defined(__SSSE3__)
+#include <immintrin.h>
+
+// Row "row" in bytes 0-8.  The last row is loaded ending at the last
+// cell and shifted down, so no read goes past the grid.
+static inline __m128i load_row(const sudoku_grid_t* grid, int row) {
+    if (row < PUZZLE_SIZE - 1) {
+        return _mm_loadu_si128((const __m128i*)&grid->cell[row * PUZZLE_SIZE]);
+    }
+    return _mm_srli_si128(_mm_loadu_si128((const __m128i*)&grid->cell[PUZZLE_CELLS - 16]), 7);
+}
+
+// Each row is turned into two byte planes: "lo" has bit d-1 set for
+// digits d = 1-8 and "is9" is 0xff where the digit is 9.  A region is
+// valid when the OR of its lo bytes is 0xff and some cell is a 9 (and
+// every cell is at most 9).  Columns are ORs of whole rows, boxes ORs
+// of three rows followed by three neighbouring bytes, and each row is
+// folded down to its first 16-bit lane.
+int check_grid_simd(const sudoku_grid_t* grid) {
+    const __m128i bits = _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, (char)128,
+                                       0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                       0, 0, 0, 0, 0, 0, 0);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i ones = _mm_set1_epi8(-1);
+    __m128i cols = _mm_setzero_si128(), cols9 = _mm_setzero_si128();
+    __m128i rows = ones, boxes = ones, top = _mm_setzero_si128();
+
+    for (int band = 0; band < PUZZLE_SIZE; band += 3) {
+        __m128i box = _mm_setzero_si128(), box9 = _mm_setzero_si128();
+        for (int row = band; row < band + 3; row++) {
+            __m128i v = _mm_and_si128(load_row(grid, row), mask);
+            __m128i lo = _mm_and_si128(_mm_shuffle_epi8(bits, v), mask);
+            __m128i is9 = _mm_cmpeq_epi8(v, nine);
+            top = _mm_max_epu8(top, v);
+            cols = _mm_or_si128(cols, lo);
+            cols9 = _mm_or_si128(cols9, is9);
+            box = _mm_or_si128(box, lo);
+            box9 = _mm_or_si128(box9, is9);
+
+            __m128i w = _mm_or_si128(_mm_unpacklo_epi8(lo, is9), _mm_unpackhi_epi8(lo, is9));
+            w = _mm_or_si128(w, _mm_srli_si128(w, 8));
+            w = _mm_or_si128(w, _mm_srli_si128(w, 4));
+            w = _mm_or_si128(w, _mm_srli_si128(w, 2));
+            rows = _mm_and_si128(rows, w);
+        }
+        box = _mm_or_si128(box, _mm_or_si128(_mm_srli_si128(box, 1), _mm_srli_si128(box, 2)));
+        box9 = _mm_or_si128(box9, _mm_or_si128(_mm_srli_si128(box9, 1), _mm_srli_si128(box9, 2)));
+        boxes = _mm_and_si128(boxes, _mm_and_si128(box, box9));
+    }
+
+    int ok_cols = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(cols, cols9), ones));
+    int ok_rows = _mm_movemask_epi8(_mm_cmpeq_epi8(rows, ones));
+    int ok_boxes = _mm_movemask_epi8(_mm_cmpeq_epi8(boxes, ones));
+    int ok_range = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(top, nine), nine));
+    return (ok_cols & 0x1ff) == 0x1ff && (ok_rows & 0x3) == 0x3 &&
+           (ok_boxes & 0x49) == 0x49 && ok_range == 0xffff;
+}
+#else
+int check_grid_simd(const sudoku_grid_t* grid) {
+    return check_grid_masks(grid);
+}
+#endif
+
+#if defined(__AVX2__)
+// check_grid_simd() on two grids at once, grid a in the low and grid
+// b in the high 128-bit lane (every step stays within its lane).
+static void check_grid_pair(const sudoku_grid_t* a, const sudoku_grid_t* b,
+                            unsigned char* valid) {
+    const __m256i bits = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i mask = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i ones = _mm256_set1_epi8(-1);
+    __m256i cols = _mm256_setzero_si256(), cols9 = _mm256_setzero_si256();
+    __m256i rows = ones, boxes = ones, top = _mm256_setzero_si256();
+
+    for (int band = 0; band < PUZZLE_SIZE; band += 3) {
+        __m256i box = _mm256_setzero_si256(), box9 = _mm256_setzero_si256();
+        for (int row = band; row < band + 3; row++) {
+            __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(load_row(a, row)),
+                                                load_row(b, row), 1);
+            v = _mm256_and_si256(v, mask);
+            __m256i lo = _mm256_and_si256(_mm256_shuffle_epi8(bits, v), mask);
+            __m256i is9 = _mm256_cmpeq_epi8(v, nine);
+            top = _mm256_max_epu8(top, v);
+            cols = _mm256_or_si256(cols, lo);
+            cols9 = _mm256_or_si256(cols9, is9);
+            box = _mm256_or_si256(box, lo);
+            box9 = _mm256_or_si256(box9, is9);
+
+            __m256i w = _mm256_or_si256(_mm256_unpacklo_epi8(lo, is9), _mm256_unpackhi_epi8(lo, is9));
+            w = _mm256_or_si256(w, _mm256_srli_si256(w, 8));
+            w = _mm256_or_si256(w, _mm256_srli_si256(w, 4));
+            w = _mm256_or_si256(w, _mm256_srli_si256(w, 2));
+            rows = _mm256_and_si256(rows, w);
+        }
+        box = _mm256_or_si256(box, _mm256_or_si256(_mm256_srli_si256(box, 1), _mm256_srli_si256(box, 2)));
+        box9 = _mm256_or_si256(box9, _mm256_or_si256(_mm256_srli_si256(box9, 1), _mm256_srli_si256(box9, 2)));
+        boxes = _mm256_and_si256(boxes, _mm256_and_si256(box, box9));
+    }
+
+    unsigned ok_cols = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(cols, cols9), ones));
+    unsigned ok_rows = _mm256_movemask_epi8(_mm256_cmpeq_epi8(rows, ones));
+    unsigned ok_boxes = _mm256_movemask_epi8(_mm256_cmpeq_epi8(boxes, ones));
+    unsigned ok_range = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(top, nine), nine));
+    for (int lane = 0; lane < 2; lane++) {
+        unsigned shift = 16 * lane;
+        valid[lane] = ((ok_cols >> shift) & 0x1ff) == 0x1ff &&
+                      ((ok_rows >> shift) & 0x3) == 0x3 &&
+                      ((ok_boxes >> shift) & 0x49) == 0x49 &&
+                      ((ok_range >> shift) & 0xffff) == 0xffff;
+    }
+}
+#endif
+
+void check_grids(const sudoku_grid_t* grids, unsigned char* valid, int n) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 1 < n; i += 2) {
+        check_grid_pair(&grids[i], &grids[i + 1], &valid[i]);
+    }
+#endif
+    for (; i < n; i++) {
+        valid[i] = check_grid_simd(&grids[i]);
+    }
+}
+
+int sudoku_diagnose(const sudoku_grid_t* grid, sudoku_diag_t* diag) {
+    // digit counts of every row, column and box (index 0 counts the
+    // cells that aren't digits)
+    unsigned char count[3][PUZZLE_SIZE][PUZZLE_SIZE + 1];
+
+    memset(diag, 0, sizeof(*diag));
+    memset(count, 0, sizeof(count));
+    for (int row = 0; row < PUZZLE_SIZE; row++) {
+        for (int col = 0; col < PUZZLE_SIZE; col++) {
+            int num = GRID_AT(grid, row, col);
+            int digit = (num >= 1 && num <= PUZZLE_SIZE) ? num : 0;
+            count[0][row][digit]++;
+            count[1][col][digit]++;
+            count[2][row / 3 * 3 + col / 3][digit]++;
+        }
+    }
+
+    uint16_t* flags[3] = { &diag->rows, &diag->cols, &diag->boxes };
+    for (int kind = 0; kind < 3; kind++) {
+        for (int unit = 0; unit < PUZZLE_SIZE; unit++) {
+            for (int digit = 0; digit <= PUZZLE_SIZE; digit++) {
+                if (count[kind][unit][digit] != (digit != 0)) {
+                    *flags[kind] |= 1 << unit;
+                }
+            }
+        }
+    }
+
+    for (int row = 0; row < PUZZLE_SIZE; row++) {
+        for (int col = 0; col < PUZZLE_SIZE; col++) {
+            int num = GRID_AT(grid, row, col);
+            int digit = (num >= 1 && num <= PUZZLE_SIZE) ? num : 0;
+            if (digit == 0 || count[0][row][digit] > 1 || count[1][col][digit] > 1 ||
+                count[2][row / 3 * 3 + col / 3][digit] > 1) {
+                int i = row * PUZZLE_SIZE + col;
+                diag->cells[i / 8] |= 1 << (i % 8);
+                diag->num_cells++;
+            }
+        }
+    }
+    return (diag->rows | diag->cols | diag->boxes) == 0;
+}
+
+// Appends the units set in mask as "name 1,4; ".
+static size_t format_units(char* text, size_t size, size_t len, const char* name,
+                           unsigned mask) {
+    if (mask == 0) {
+        return len;
+    }
+    len += snprintf(text + len, len < size ? size - len : 0, "%s ", name);
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        if (mask & (1 << i)) {
+            mask &= ~(1u << i);
+            len += snprintf(text + len, len < size ? size - len : 0, "%d%s", i + 1,
+                            mask ? "," : "; ");
+        }
+    }
+    return len;
+}
+
+void sudoku_format_diag(const sudoku_diag_t* diag, char* text, size_t size) {
+    size_t len = 0;
+
+    text[0] = '\0';
+    len = format_units(text, size, len, "rows", diag->rows);
+    len = format_units(text, size, len, "columns", diag->cols);
+    len = format_units(text, size, len, "boxes", diag->boxes);
+    if (diag->num_cells > 0) {
+        len += snprintf(text + len, len < size ? size - len : 0, "cells");
+        for (int i = 0; i < PUZZLE_CELLS; i++) {
+            if (DIAG_CELL(diag, i)) {
+                len += snprintf(text + len, len < size ? size - len : 0, " r%dc%d",
+                                i / PUZZLE_SIZE + 1, i % PUZZLE_SIZE + 1);
+            }
+        }
+    } else if (len >= 2 && len < size) {
+        text[len - 2] = '\0'; // drop the last "; "
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef sudoku_check_h
+#define sudoku_check_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PUZZLE_SIZE  9
+#define PUZZLE_CELLS (PUZZLE_SIZE * PUZZLE_SIZE)
+
+// A 9x9 grid packed one byte per cell, row by row.  A valid solution
+// holds the digits 1-9; anything else (0 for an empty cell, or an out
+// of range value) makes the grid not valid.
+typedef struct {
+    unsigned char cell[PUZZLE_CELLS];
+} sudoku_grid_t;
+
+#define GRID_AT(g, row, col) ((g)->cell[(row) * PUZZLE_SIZE + (col)])
+
+// Each check returns 1 if its region holds each of the digits 1-9
+// exactly once, 0 otherwise.
+int check_row(const sudoku_grid_t* grid, int row);
+int check_col(const sudoku_grid_t* grid, int col);
+int check_subgrid(const sudoku_grid_t* grid, int rowStart, int colStart);
+
+// Single-threaded pass over all 27 regions.
+int check_grid(const sudoku_grid_t* grid);
+
+// One pass over the grid building a 9-bit digit mask per row, column
+// and box; the grid is valid when all 27 masks are full.
+int check_grid_masks(const sudoku_grid_t* grid);
+
+// The same check on whole rows at a time with SSSE3 shuffles and
+// compares (falls back to check_grid_masks() without SSSE3).
+int check_grid_simd(const sudoku_grid_t* grid);
+
+// Validates n grids into valid[0..n-1] with the fastest kernel built
+// in: with AVX2 two grids go through the SIMD check at once.
+void check_grids(const sudoku_grid_t* grids, unsigned char* valid, int n);
+
+// What is wrong with a grid that isn't valid.  Rows, columns and boxes
+// are numbered 0-8 (boxes row by row); a unit is flagged when it
+// doesn't hold each digit exactly once.  A cell is flagged when it
+// holds something other than 1-9, or a digit repeated in its row,
+// column or box.
+typedef struct {
+    uint16_t rows, cols, boxes;              // bit i: unit i is flagged
+    uint8_t cells[(PUZZLE_CELLS + 7) / 8];   // bit i % 8 of byte i / 8: cell i
+    uint8_t num_cells;                       // flagged cells
+} sudoku_diag_t;
+
+#define DIAG_CELL(d, i) (((d)->cells[(i) / 8] >> ((i) % 8)) & 1)
+
+// Fills diag for grid and returns 1 if the grid is valid.  Slower than
+// the checks above: run it on the grids they reject.
+int sudoku_diagnose(const sudoku_grid_t* grid, sudoku_diag_t* diag);
+
+// Writes diag as text, like "rows 1,4; boxes 2; cells r1c3 r4c3", with
+// rows, columns, boxes and cells numbered from 1.
+void sudoku_format_diag(const sudoku_diag_t* diag, char* text, size_t size);
+
+#endif // sudoku_check_h
@@ -0,0 +1,102 @@
+#include "sudoku_corpus.h"
+
+// the valid solution every grid is derived from
+static const unsigned char base_grid[PUZZLE_CELLS] = {
+    6, 2, 4, 5, 3, 9, 1, 8, 7,
+    5, 1, 9, 7, 2, 8, 6, 3, 4,
+    8, 3, 7, 6, 1, 4, 2, 9, 5,
+    1, 4, 3, 8, 6, 5, 7, 2, 9,
+    9, 5, 8, 2, 4, 7, 3, 6, 1,
+    7, 6, 2, 3, 9, 1, 4, 5, 8,
+    3, 7, 1, 9, 5, 6, 8, 4, 2,
+    4, 9, 6, 1, 8, 2, 5, 7, 3,
+    2, 8, 5, 4, 7, 3, 9, 1, 6,
+};
+
+static const char* kind_names[CORPUS_NUM_KINDS] = {
+    "valid", "single error", "many errors", "malformed",
+};
+
+const char* corpus_kind_name(corpus_kind_t kind) {
+    return kind_names[kind];
+}
+
+static void shuffle(rng_t* rng, int* a, int n) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)rng_below(rng, i + 1);
+        int t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+    }
+}
+
+void corpus_valid_grid(rng_t* rng, sudoku_grid_t* grid) {
+    int digit[PUZZLE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int row[PUZZLE_SIZE], col[PUZZLE_SIZE];
+    int band[3] = {0, 1, 2}, stack[3] = {0, 1, 2};
+
+    shuffle(rng, digit, PUZZLE_SIZE);
+    shuffle(rng, band, 3);
+    shuffle(rng, stack, 3);
+    for (int b = 0; b < 3; b++) {
+        int inner[3] = {0, 1, 2};
+        shuffle(rng, inner, 3);
+        for (int k = 0; k < 3; k++) {
+            row[b * 3 + k] = band[b] * 3 + inner[k];
+        }
+        shuffle(rng, inner, 3);
+        for (int k = 0; k < 3; k++) {
+            col[b * 3 + k] = stack[b] * 3 + inner[k];
+        }
+    }
+    int transpose = (int)rng_below(rng, 2);
+    for (int r = 0; r < PUZZLE_SIZE; r++) {
+        for (int c = 0; c < PUZZLE_SIZE; c++) {
+            int src = transpose ? col[c] * PUZZLE_SIZE + row[r]
+                                : row[r] * PUZZLE_SIZE + col[c];
+            GRID_AT(grid, r, c) = digit[base_grid[src] - 1];
+        }
+    }
+}
+
+void corpus_grid(rng_t* rng, corpus_kind_t kind, sudoku_grid_t* grid) {
+    corpus_valid_grid(rng, grid);
+    if (kind == CORPUS_SINGLE_ERROR) {
+        // another digit: skip over the one the cell holds
+        int i = (int)rng_below(rng, PUZZLE_CELLS);
+        int digit = (int)rng_below(rng, PUZZLE_SIZE - 1) + 1;
+        grid->cell[i] = digit + (digit >= grid->cell[i]);
+    } else if (kind == CORPUS_MANY_ERRORS) {
+        // changes can (rarely) undo each other, or make another solution
+        do {
+            int errors = (int)rng_range(rng, 2, 20);
+            for (int k = 0; k < errors; k++) {
+                grid->cell[rng_below(rng, PUZZLE_CELLS)] = (unsigned char)rng_below(rng, 10);
+            }
+        } while (check_grid_masks(grid));
+    }
+}
+
+int corpus_line(rng_t* rng, corpus_kind_t kind, char* line) {
+    sudoku_grid_t grid;
+    corpus_grid(rng, kind, &grid);
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        line[i] = '0' + grid.cell[i];
+    }
+    int len = PUZZLE_CELLS;
+    if (kind == CORPUS_MALFORMED) {
+        switch (rng_below(rng, 3)) {
+        case 0: // a character that isn't a digit or '.'
+            line[rng_below(rng, PUZZLE_CELLS)] = "x#/:-"[rng_below(rng, 5)];
+            break;
+        case 1: // one cell too many
+            line[len++] = '1' + (char)rng_below(rng, PUZZLE_SIZE);
+            break;
+        case 2: // cut short
+            len = (int)rng_range(rng, 9, PUZZLE_CELLS - 1);
+            break;
+        }
+    }
+    line[len++] = '\n';
+    return len;
+}
@@ -0,0 +1,35 @@
+#ifndef sudoku_corpus_h
+#define sudoku_corpus_h
+
+#include "rng.h"
+#include "sudoku_check.h"
+
+// Random test grids for the benchmarks, in four kinds.  Grids are
+// written as the one-line format sudoku_parse.h reads: 81 digits and a
+// newline.
+typedef enum {
+    CORPUS_VALID,         // a valid solution
+    CORPUS_SINGLE_ERROR,  // a valid solution with one cell changed to another digit
+    CORPUS_MANY_ERRORS,   // 2-20 cells changed, to any value 0-9
+    CORPUS_MALFORMED,     // a line the parser rejects
+} corpus_kind_t;
+
+#define CORPUS_NUM_KINDS 4
+#define CORPUS_MAX_LINE  (PUZZLE_CELLS + 2) // longest line, with its newline
+
+const char* corpus_kind_name(corpus_kind_t kind);
+
+// A random valid grid: a fixed solution with its digits relabelled,
+// bands and stacks permuted, rows and columns permuted within them, and
+// maybe transposed.
+void corpus_valid_grid(rng_t* rng, sudoku_grid_t* grid);
+
+// A random grid of the kind (for CORPUS_MALFORMED, the valid grid the
+// line was made from).
+void corpus_grid(rng_t* rng, corpus_kind_t kind, sudoku_grid_t* grid);
+
+// Writes a random line of the kind to line (at most CORPUS_MAX_LINE
+// characters, not NUL terminated) and returns its length.
+int corpus_line(rng_t* rng, corpus_kind_t kind, char* line);
+
+#endif // sudoku_corpus_h
@@ -0,0 +1,102 @@
+// Counts the solutions of each puzzle in a file (or stdin) with the
+// parallel work-stealing search, and reports the search rate (nodes
+// per second) and how much work moved between threads (steals).  With
+// -s each puzzle is run on 1, 2, 4, ... threads up to -t, to show how
+// the search scales.
+//
+// to compile enter:
+//    cc -Wall -O2 -march=native -I../common sudoku_count.c sudoku_parallel.c sudoku_solver.c sudoku_parse.c sudoku_check.c ../common/rng.c -lpthread
+// usage:
+//    ./a.out [-t threads] [-d split_depth] [-l limit] [-s] [file]
+//       -t  worker threads (default: one per CPU)
+//       -d  guesses deep to keep splitting the tree into tasks (default 6)
+//       -l  stop after this many solutions (default: count them all)
+//       -s  scaling run on 1, 2, 4, ... threads
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sudoku_parallel.h"
+#include "sudoku_parse.h"
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Runs one count and prints a line for it; returns the elapsed time.
+static double run(const sudoku_grid_t* puzzle, long index, long limit, int threads,
+                  int depth) {
+    parallel_stats_t stats;
+    double start = now_sec();
+    long count = parallel_count(puzzle, limit, threads, depth, NULL, &stats);
+    double elapsed = now_sec() - start;
+    if (count < 0) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    printf("puzzle %ld | %7d | %12ld | %12ld | %12.0f | %8ld | %7ld | %9.4f\n", index,
+           threads, count, stats.nodes, elapsed > 0 ? stats.nodes / elapsed : 0.0,
+           stats.tasks, stats.steals, elapsed);
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int depth = 6, scaling = 0;
+    long limit = LONG_MAX;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:d:l:s")) != -1) {
+        switch (opt) {
+        case 't': num_threads = atoi(optarg); break;
+        case 'd': depth = atoi(optarg); break;
+        case 'l': limit = atol(optarg); break;
+        case 's': scaling = 1; break;
+        default:
+            printf("Usage: %s [-t threads] [-d split_depth] [-l limit] [-s] "
+                   "[sudoku_puzzle_file]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_threads < 1 || depth < 0 || limit < 1) {
+        printf("Threads and limit must be positive, and depth not negative\n");
+        return 1;
+    }
+
+    sudoku_parser_t parser;
+    if (parser_open(&parser, optind < argc ? argv[optind] : NULL) != 0) {
+        printf("%s\n", parser.error);
+        return 1;
+    }
+
+    printf("Puzzle   | Threads | Solutions    | Nodes        | Nodes/sec    "
+           "| Tasks    | Steals  | Seconds\n");
+    sudoku_grid_t puzzle;
+    long index = 0;
+    int got;
+    while ((got = parser_next(&parser, &puzzle)) != 0) {
+        if (got < 0) {
+            fprintf(stderr, "puzzle %ld: %s\n", index++, parser.error);
+            continue;
+        }
+        if (!scaling) {
+            run(&puzzle, index, limit, num_threads, depth);
+        } else {
+            double base = run(&puzzle, index, limit, 1, depth);
+            for (int t = 2; t / 2 < num_threads; t *= 2) {
+                int threads = t < num_threads ? t : num_threads;
+                double elapsed = run(&puzzle, index, limit, threads, depth);
+                printf("         speedup %.2fx, efficiency %.0f%%\n", base / elapsed,
+                       100 * base / elapsed / threads);
+            }
+        }
+        index++;
+    }
+    parser_close(&parser);
+    return 0;
+}
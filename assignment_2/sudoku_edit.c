@@ -0,0 +1,279 @@
+// Simulates many interactive editing sessions, one sudoku_tracker_t
+// each, and compares the incremental tracker against revalidating the
+// whole grid (sudoku_diagnose()) after every edit.  Each session starts
+// from a puzzle with about 3/4 of its cells given and fills it in, with
+// some wrong digits and erasures along the way, so it passes through
+// grids with and without conflicts and sometimes becomes valid.  The
+// tracker is timed both on its own (validity and the conflicting units,
+// which it keeps up to date) and listing the conflicting cells after
+// every edit that leaves any.  It is first cross-checked against the
+// full check on every edit of the first sessions.  Sessions are split
+// among threads; each thread only touches its own sessions, so no
+// locking.
+//
+// to compile enter:
+//    cc -Wall -O2 -march=native -I../common sudoku_edit.c sudoku_tracker.c sudoku_check.c ../common/rng.c -lpthread
+// usage:
+//    ./a.out [-t threads] [-n sessions] [-e edits]
+//       -n  sessions (default 200000)
+//       -e  edits per session (default 100)
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rng.h"
+#include "sudoku_check.h"
+#include "sudoku_tracker.h"
+
+#define START_SEED 11 // arbitrary value to seed random number generator
+#define CROSS_CHECK_SESSIONS 1000
+
+// the solution every session works towards, with its digits relabelled
+static const unsigned char base_grid[PUZZLE_CELLS] = {
+    6, 2, 4, 5, 3, 9, 1, 8, 7,
+    5, 1, 9, 7, 2, 8, 6, 3, 4,
+    8, 3, 7, 6, 1, 4, 2, 9, 5,
+    1, 4, 3, 8, 6, 5, 7, 2, 9,
+    9, 5, 8, 2, 4, 7, 3, 6, 1,
+    7, 6, 2, 3, 9, 1, 4, 5, 8,
+    3, 7, 1, 9, 5, 6, 8, 4, 2,
+    4, 9, 6, 1, 8, 2, 5, 7, 3,
+    2, 8, 5, 4, 7, 3, 9, 1, 6,
+};
+
+typedef struct {
+    int cell;
+    int digit;
+} edit_t;
+
+// The solution of a session has digit d relabelled to (d + label) % 9 + 1.
+static int solution(int cell, int label) {
+    return (base_grid[cell] + label) % PUZZLE_SIZE + 1;
+}
+
+// The starting puzzle of a session: each cell of its solution given
+// with probability 3/4.
+static void make_puzzle(rng_t* rng, int label, sudoku_grid_t* grid) {
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        grid->cell[i] = rng_below(rng, 4) ? solution(i, label) : 0;
+    }
+}
+
+// The next edit of a session: mostly the right digit, sometimes a wrong
+// one (which may happen to be right) or an erasure.
+static edit_t next_edit(rng_t* rng, int label) {
+    edit_t edit;
+    edit.cell = (int)rng_below(rng, PUZZLE_CELLS);
+    int roll = (int)rng_below(rng, 100);
+    if (roll < 98) {
+        edit.digit = solution(edit.cell, label);
+    } else if (roll < 99) {
+        edit.digit = (int)rng_below(rng, PUZZLE_SIZE) + 1;
+    } else {
+        edit.digit = 0;
+    }
+    return edit;
+}
+
+// Runs every edit through both the tracker and a full sudoku_diagnose()
+// and stops at the first disagreement.  Empty cells are flagged only by
+// sudoku_diagnose(), and so are the units holding them.
+static void cross_check(int sessions, int edits) {
+    rng_t rng;
+    rng_seed(&rng, START_SEED);
+    for (int s = 0; s < sessions; s++) {
+        sudoku_tracker_t tracker;
+        sudoku_grid_t grid, copy;
+        sudoku_diag_t expect, got;
+        int label = (int)rng_below(&rng, PUZZLE_SIZE);
+
+        make_puzzle(&rng, label, &grid);
+        tracker_init(&tracker, &grid);
+        for (int e = 0; e < edits; e++) {
+            edit_t edit = next_edit(&rng, label);
+            grid.cell[edit.cell] = edit.digit;
+            int valid = tracker_set(&tracker, edit.cell / PUZZLE_SIZE,
+                                    edit.cell % PUZZLE_SIZE, edit.digit);
+            int ok = sudoku_diagnose(&grid, &expect) == valid &&
+                     tracker_diagnose(&tracker, &got) == valid &&
+                     check_grid_masks(&grid) == valid;
+            for (int i = 0; i < PUZZLE_CELLS; i++) {
+                ok &= DIAG_CELL(&got, i) == (DIAG_CELL(&expect, i) && grid.cell[i] != 0);
+            }
+            if (tracker.filled == PUZZLE_CELLS) {
+                ok &= got.rows == expect.rows && got.cols == expect.cols &&
+                      got.boxes == expect.boxes && got.num_cells == expect.num_cells;
+            }
+            tracker_grid(&tracker, &copy);
+            ok &= memcmp(&copy, &grid, sizeof(grid)) == 0;
+            if (!ok) {
+                printf("tracker disagrees with sudoku_diagnose on session %d, edit %d\n",
+                       s, e);
+                exit(1);
+            }
+        }
+    }
+}
+
+typedef struct {
+    int first, count;     // sessions this thread edits
+    int edits;
+    int list_cells;       // list the conflicting cells after each edit
+    uint64_t seed;
+    long valid;           // edits that left a session valid
+    long conflicts;       // edits that left a session with conflicts
+} job_t;
+
+static sudoku_grid_t* puzzles;   // where each session starts
+static sudoku_tracker_t* trackers;
+static sudoku_grid_t* grids;
+static unsigned char* labels;
+
+// Takes each session of the job through "edits" rounds, one edit per
+// session per round, so consecutive edits land on different sessions.
+static void* edit_tracked(void* param) {
+    job_t* job = (job_t*)param;
+    rng_t rng;
+    sudoku_diag_t diag;
+
+    rng_seed(&rng, job->seed);
+    for (int e = 0; e < job->edits; e++) {
+        for (int s = job->first; s < job->first + job->count; s++) {
+            edit_t edit = next_edit(&rng, labels[s]);
+            job->valid += tracker_set(&trackers[s], edit.cell / PUZZLE_SIZE,
+                                      edit.cell % PUZZLE_SIZE, edit.digit);
+            if (trackers[s].repeats != 0) {
+                if (job->list_cells) {
+                    tracker_diagnose(&trackers[s], &diag);
+                }
+                job->conflicts++;
+            }
+        }
+    }
+    return NULL;
+}
+
+// The same edits on plain grids, revalidated from scratch every time.
+static void* edit_full(void* param) {
+    job_t* job = (job_t*)param;
+    rng_t rng;
+    sudoku_diag_t diag;
+
+    rng_seed(&rng, job->seed);
+    for (int e = 0; e < job->edits; e++) {
+        for (int s = job->first; s < job->first + job->count; s++) {
+            edit_t edit = next_edit(&rng, labels[s]);
+            grids[s].cell[edit.cell] = edit.digit;
+            job->valid += sudoku_diagnose(&grids[s], &diag);
+            // empty cells are flagged too: a conflict is a flagged digit
+            for (int i = 0; i < PUZZLE_CELLS; i++) {
+                if (DIAG_CELL(&diag, i) && grids[s].cell[i] != 0) {
+                    job->conflicts++;
+                    break;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// Runs fn on every job and returns the elapsed seconds.
+static double run(void* (*fn)(void*), job_t* jobs, int num_threads, uint64_t seed,
+                  int list_cells) {
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < num_threads; i++) {
+        jobs[i].seed = seed + i;
+        jobs[i].list_cells = list_cells;
+        jobs[i].valid = jobs[i].conflicts = 0;
+        pthread_create(&threads[i], NULL, fn, &jobs[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(threads);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int sessions = 200000, edits = 100;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:e:")) != -1) {
+        switch (opt) {
+        case 't': num_threads = atoi(optarg); break;
+        case 'n': sessions = atoi(optarg); break;
+        case 'e': edits = atoi(optarg); break;
+        default:
+            printf("Usage: %s [-t threads] [-n sessions] [-e edits]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_threads < 1 || sessions < 1 || edits < 1) {
+        printf("Threads, sessions and edits must be positive\n");
+        return 1;
+    }
+    if (num_threads > sessions) {
+        num_threads = sessions;
+    }
+
+    cross_check(sessions < CROSS_CHECK_SESSIONS ? sessions : CROSS_CHECK_SESSIONS, edits);
+
+    puzzles = malloc((size_t)sessions * sizeof(sudoku_grid_t));
+    grids = malloc((size_t)sessions * sizeof(sudoku_grid_t));
+    trackers = malloc((size_t)sessions * sizeof(sudoku_tracker_t));
+    labels = malloc(sessions);
+    job_t* jobs = calloc(num_threads, sizeof(job_t));
+    if (puzzles == NULL || grids == NULL || trackers == NULL || labels == NULL ||
+        jobs == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    rng_t rng;
+    rng_seed(&rng, START_SEED);
+    for (int s = 0; s < sessions; s++) {
+        labels[s] = (unsigned char)rng_below(&rng, PUZZLE_SIZE);
+        make_puzzle(&rng, labels[s], &puzzles[s]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        jobs[i].first = (int)((long)sessions * i / num_threads);
+        jobs[i].count = (int)((long)sessions * (i + 1) / num_threads) - jobs[i].first;
+        jobs[i].edits = edits;
+    }
+
+    printf("%d sessions, %d edits each, %d threads\n", sessions, edits, num_threads);
+    printf("Method       | bytes/session | ns/edit    | edits/sec      | valid   | conflicts\n");
+    const char* names[3] = { "incremental", "+ cell list", "full check" };
+    for (int m = 0; m < 3; m++) {
+        // every method replays the same edits from the same puzzles
+        for (int s = 0; s < sessions; s++) {
+            tracker_init(&trackers[s], &puzzles[s]);
+            grids[s] = puzzles[s];
+        }
+        double elapsed = run(m < 2 ? edit_tracked : edit_full, jobs, num_threads,
+                             START_SEED, m == 1);
+        long total = (long)sessions * edits, valid = 0, conflicts = 0;
+        for (int i = 0; i < num_threads; i++) {
+            valid += jobs[i].valid;
+            conflicts += jobs[i].conflicts;
+        }
+        printf("%-12s | %13zu | %10.1f | %14.0f | %7ld | %ld\n", names[m],
+               m < 2 ? sizeof(sudoku_tracker_t) : sizeof(sudoku_grid_t),
+               elapsed * 1e9 / total, total / elapsed, valid, conflicts);
+    }
+
+    free(jobs);
+    free(labels);
+    free(trackers);
+    free(grids);
+    free(puzzles);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include "sudoku_gen.h"
+#include "sudoku_solver.h"
+
+static const char* names[GEN_NUM_TIERS] = { "easy", "medium", "hard", "expert" };
+
+// fewest nodes of each tier
+static const long tier_nodes[GEN_NUM_TIERS] = { 1, 2, 4, 16 };
+
+const char* gen_tier_name(gen_tier_t tier) {
+    return names[tier];
+}
+
+int gen_tier_parse(const char* name) {
+    for (int i = 0; i < GEN_NUM_TIERS; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// A random one of the digits in cand (bit d-1 for digit d).
+static int random_digit(rng_t* rng, unsigned cand) {
+    for (int k = (int)rng_below(rng, __builtin_popcount(cand)); k > 0; k--) {
+        cand &= cand - 1;
+    }
+    return __builtin_ctz(cand) + 1;
+}
+
+void gen_solution(rng_t* rng, sudoku_grid_t* solution) {
+    static const sudoku_grid_t empty;
+    solver_board_t board, child;
+
+    // Fill the cell with the fewest candidates with a random one of
+    // them, and propagate.  Propagation makes dead ends rare; when all
+    // candidates of a cell fail, start over.
+    solver_init(&board, &empty);
+    int cell;
+    while ((cell = solver_choose(&board)) >= 0) {
+        unsigned cand = solver_candidates(&board, cell);
+        int placed = 0;
+        while (cand && !placed) {
+            int digit = random_digit(rng, cand);
+            cand &= ~(1u << (digit - 1));
+            placed = solver_try(&board, cell, digit, &child);
+        }
+        if (placed) {
+            board = child;
+        } else {
+            solver_init(&board, &empty);
+        }
+    }
+    solver_grid(&board, solution);
+}
+
+// Whether puzzle, which has a unique solution, keeps it with cell
+// emptied: only if no other digit there leads to a solution.
+static int unique_without(const sudoku_grid_t* puzzle, int cell) {
+    sudoku_grid_t without = *puzzle;
+    solver_board_t board, child;
+
+    without.cell[cell] = 0;
+    solver_init(&board, &without);
+    unsigned cand = solver_candidates(&board, cell) & ~(1u << (puzzle->cell[cell] - 1));
+    while (cand) {
+        int digit = __builtin_ctz(cand) + 1;
+        cand &= cand - 1;
+        if (solver_try(&board, cell, digit, &child) &&
+            solver_count(&child, 1, NULL, NULL) > 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int gen_minimal(rng_t* rng, const sudoku_grid_t* solution, sudoku_grid_t* puzzle) {
+    int order[PUZZLE_CELLS];
+    int clues = PUZZLE_CELLS;
+
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        order[i] = i;
+    }
+    for (int i = PUZZLE_CELLS - 1; i > 0; i--) {
+        int j = (int)rng_below(rng, i + 1);
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    *puzzle = *solution;
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        int cell = order[i];
+        if (unique_without(puzzle, cell)) {
+            puzzle->cell[cell] = 0;
+            clues--;
+        }
+    }
+    return clues;
+}
+
+gen_tier_t gen_rate(const sudoku_grid_t* puzzle, long* nodes) {
+    solver_stats_t stats = {0, 0};
+    sudoku_solve(puzzle, NULL, 2, &stats);
+    if (nodes != NULL) {
+        *nodes = stats.nodes;
+    }
+    int tier = GEN_NUM_TIERS - 1;
+    while (tier > 0 && stats.nodes < tier_nodes[tier]) {
+        tier--;
+    }
+    return (gen_tier_t)tier;
+}
@@ -0,0 +1,34 @@
+#ifndef sudoku_gen_h
+#define sudoku_gen_h
+
+#include "rng.h"
+#include "sudoku_check.h"
+
+// Difficulty tiers, by the search nodes the solver needs to solve a
+// puzzle and prove its solution unique:
+//   GEN_EASY   : 1 (naked/hidden singles and locked candidates suffice)
+//   GEN_MEDIUM : 2-3
+//   GEN_HARD   : 4-15
+//   GEN_EXPERT : 16 or more
+typedef enum gen_tiers { GEN_EASY, GEN_MEDIUM, GEN_HARD, GEN_EXPERT } gen_tier_t;
+
+#define GEN_NUM_TIERS 4
+
+// "easy", "medium", "hard" or "expert"; gen_tier_parse() returns -1 for
+// any other name
+const char* gen_tier_name(gen_tier_t tier);
+int gen_tier_parse(const char* name);
+
+// A random complete, valid grid.
+void gen_solution(rng_t* rng, sudoku_grid_t* solution);
+
+// A random minimal puzzle for solution: clues are removed in random
+// order while the solution stays unique, so no remaining clue can be
+// removed.  Returns the number of clues.
+int gen_minimal(rng_t* rng, const sudoku_grid_t* solution, sudoku_grid_t* puzzle);
+
+// Tier of a puzzle with a unique solution; the nodes the solver took
+// go to *nodes, if not NULL.
+gen_tier_t gen_rate(const sudoku_grid_t* puzzle, long* nodes);
+
+#endif // sudoku_gen_h
@@ -0,0 +1,155 @@
+// Puzzle generator: writes minimal puzzles with a unique solution, one
+// 81-character line each ('.' for an empty cell), for each difficulty
+// tier asked for (all of them by default).  Generation runs on a pool
+// of threads; each keeps its puzzles in a batch and writes the whole
+// batch at once.  For each tier, the puzzles/sec (and how many
+// candidates were made to find them) goes to stderr.
+//
+// to compile enter:
+//    cc -Wall -O2 -march=native -I../common sudoku_generate.c sudoku_gen.c sudoku_solver.c sudoku_check.c ../common/rng.c -lpthread
+// usage:
+//    ./a.out [-t threads] [-n count] [-b batch] [-s seed] [easy|medium|hard|expert ...]
+//       -n  puzzles per tier (default 100)
+//       -b  puzzles a thread writes at once (default 64)
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rng.h"
+#include "sudoku_gen.h"
+
+#define START_SEED 11 // arbitrary value to seed random number generator
+
+// the tier being generated, shared by all threads
+static struct {
+    gen_tier_t tier;
+    atomic_long remaining;   // puzzles of the tier still to claim
+    atomic_long candidates;  // minimal puzzles made, of any tier
+    atomic_long clues;       // total clues of the puzzles kept
+    pthread_mutex_t out;     // one batch is written at a time
+    int batch;
+} job;
+
+static void flush(char* text, int* count) {
+    if (*count > 0) {
+        pthread_mutex_lock(&job.out);
+        fwrite(text, PUZZLE_CELLS + 1, *count, stdout);
+        pthread_mutex_unlock(&job.out);
+        *count = 0;
+    }
+}
+
+static void* generate(void* param) {
+    rng_t* rng = (rng_t*)param;
+    char* text = malloc((size_t)job.batch * (PUZZLE_CELLS + 1));
+    int count = 0;
+    sudoku_grid_t solution, puzzle;
+
+    while (text != NULL && atomic_load(&job.remaining) > 0) {
+        gen_solution(rng, &solution);
+        int clues = gen_minimal(rng, &solution, &puzzle);
+        atomic_fetch_add(&job.candidates, 1);
+        if (gen_rate(&puzzle, NULL) != job.tier) {
+            continue;
+        }
+        if (atomic_fetch_sub(&job.remaining, 1) <= 0) {
+            break; // another thread made the last one
+        }
+        atomic_fetch_add(&job.clues, clues);
+
+        char* line = text + (size_t)count * (PUZZLE_CELLS + 1);
+        for (int i = 0; i < PUZZLE_CELLS; i++) {
+            line[i] = puzzle.cell[i] ? '0' + puzzle.cell[i] : '.';
+        }
+        line[PUZZLE_CELLS] = '\n';
+        if (++count == job.batch) {
+            flush(text, &count);
+        }
+    }
+    if (text != NULL) {
+        flush(text, &count);
+    }
+    free(text);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    long count = 100;
+    unsigned long seed = START_SEED;
+    int opt;
+
+    job.batch = 64;
+    while ((opt = getopt(argc, argv, "t:n:b:s:")) != -1) {
+        switch (opt) {
+        case 't': num_threads = atoi(optarg); break;
+        case 'n': count = atol(optarg); break;
+        case 'b': job.batch = atoi(optarg); break;
+        case 's': seed = strtoul(optarg, NULL, 10); break;
+        default:
+            printf("Usage: %s [-t threads] [-n count] [-b batch] [-s seed] "
+                   "[easy|medium|hard|expert ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_threads < 1 || count < 1 || job.batch < 1) {
+        printf("Threads, count and batch must be positive\n");
+        return 1;
+    }
+
+    int tiers[GEN_NUM_TIERS], num_tiers = 0;
+    for (int i = optind; i < argc; i++) {
+        int tier = gen_tier_parse(argv[i]);
+        if (tier < 0 || num_tiers == GEN_NUM_TIERS) {
+            printf("Unknown tier %s: use easy, medium, hard or expert\n", argv[i]);
+            return 1;
+        }
+        tiers[num_tiers++] = tier;
+    }
+    if (num_tiers == 0) {
+        for (int i = 0; i < GEN_NUM_TIERS; i++) {
+            tiers[num_tiers++] = i;
+        }
+    }
+
+    rng_t* rngs = rng_streams(num_threads, seed);
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    if (rngs == NULL || threads == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    pthread_mutex_init(&job.out, NULL);
+
+    for (int k = 0; k < num_tiers; k++) {
+        job.tier = tiers[k];
+        atomic_store(&job.remaining, count);
+        atomic_store(&job.candidates, 0);
+        atomic_store(&job.clues, 0);
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < num_threads; i++) {
+            pthread_create(&threads[i], NULL, generate, &rngs[i]);
+        }
+        for (int i = 0; i < num_threads; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        fflush(stdout);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        fprintf(stderr, "%-6s: %ld puzzles (avg %.1f clues) from %ld candidates in %.3f s, "
+                "%.1f puzzles/sec, %d threads\n", gen_tier_name(job.tier), count,
+                (double)atomic_load(&job.clues) / count, atomic_load(&job.candidates),
+                elapsed, elapsed > 0 ? count / elapsed : 0.0, num_threads);
+    }
+
+    pthread_mutex_destroy(&job.out);
+    free(threads);
+    free(rngs);
+    return 0;
+}
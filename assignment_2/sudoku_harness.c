@@ -0,0 +1,299 @@
+// Benchmark harness comparing ways of validating 9x9 grids on a
+// generated corpus of four kinds of grids: valid, one error, many
+// errors and malformed (see sudoku_corpus.h), n of each.  Each kind is
+// written out as text and parsed back, then validated by:
+//
+//   11 threads   the assignment's validator (check_grid_threads()),
+//                which creates 11 threads for every grid
+//   single pass  the per-region checks on one thread (check_grid())
+//   bitmask      the one-pass bitmask check (check_grid_masks())
+//
+// The last two are also run with the grids split among 2, 4, ... up to
+// -t threads.  For each run the table gives the latency of one grid
+// (the time a thread spends on it), the throughput, and the speedup and
+// scaling efficiency (speedup / threads) over the same check on one
+// thread.  The 11-thread validator is compared with the single pass,
+// which runs the same per-region checks; it takes long enough per grid
+// that only the first -m grids of a kind go through it.  Malformed
+// grids never reach a validator; for them only the parser is timed,
+// after checking that each one is rejected on its own, without taking
+// the valid line after it along.
+//
+// to compile enter:
+//    cc -Wall -O2 -march=native -I../common sudoku_harness.c sudoku_corpus.c sudoku_threads.c sudoku_check.c sudoku_parse.c ../common/rng.c ../common/thread_launch.c -lpthread
+// usage:
+//    ./a.out [-n grids] [-m grids] [-t threads] [-s seed]
+//    ./a.out [-n grids] [-s seed] -w corpus_file
+//       -n  grids of each kind (default 1000000)
+//       -m  grids of each kind for the 11-thread validator (default 2000)
+//       -t  most threads to split the grids among (default: one per CPU)
+//       -w  write the corpus (kinds one after another) to a file instead
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rng.h"
+#include "sudoku_check.h"
+#include "sudoku_corpus.h"
+#include "sudoku_parse.h"
+#include "sudoku_threads.h"
+
+#define START_SEED 11 // arbitrary value to seed random number generator
+
+typedef int (*kernel_t)(const sudoku_grid_t*);
+
+typedef struct {
+    kernel_t kernel;
+    const sudoku_grid_t* grids;
+    unsigned char* valid;
+    int first, count;    // grids this thread checks
+} slice_t;
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* check_slice(void* param) {
+    slice_t* slice = (slice_t*)param;
+    for (int i = slice->first; i < slice->first + slice->count; i++) {
+        slice->valid[i] = (unsigned char)slice->kernel(&slice->grids[i]);
+    }
+    return NULL;
+}
+
+// Checks grids[0..n-1] with kernel, split among num_threads threads, and
+// returns the elapsed seconds.
+static double run(kernel_t kernel, const sudoku_grid_t* grids, unsigned char* valid, int n,
+                  int num_threads) {
+    pthread_t threads[num_threads];
+    slice_t slices[num_threads];
+
+    double start = now_sec();
+    for (int i = 0; i < num_threads; i++) {
+        slices[i].kernel = kernel;
+        slices[i].grids = grids;
+        slices[i].valid = valid;
+        slices[i].first = (int)((long)n * i / num_threads);
+        slices[i].count = (int)((long)n * (i + 1) / num_threads) - slices[i].first;
+        if (num_threads == 1) {
+            check_slice(&slices[i]); // no thread to create
+        } else {
+            pthread_create(&threads[i], NULL, check_slice, &slices[i]);
+        }
+    }
+    for (int i = 0; num_threads > 1 && i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return now_sec() - start;
+}
+
+// Every grid of a kind must come out the same: valid only for CORPUS_VALID.
+static void expect(const char* name, corpus_kind_t kind, const unsigned char* valid, int n) {
+    for (int i = 0; i < n; i++) {
+        if (valid[i] != (kind == CORPUS_VALID)) {
+            printf("%s got grid %d of kind \"%s\" wrong\n", name, i, corpus_kind_name(kind));
+            exit(1);
+        }
+    }
+}
+
+static void print_row(corpus_kind_t kind, const char* name, int threads, int n,
+                      double elapsed, double base) {
+    printf("%-12s | %-11s | %7d | %10.1f | %12.0f | %7.2fx | %5.0f%%\n",
+           corpus_kind_name(kind), name, threads, elapsed * 1e9 * threads / n, n / elapsed,
+           base / elapsed, 100 * base / elapsed / threads);
+}
+
+// Text of n random lines of one kind, one after another.
+static char* make_text(rng_t* rng, corpus_kind_t kind, int n, size_t* size) {
+    char* text = malloc((size_t)n * CORPUS_MAX_LINE);
+    size_t len = 0;
+    for (int i = 0; text != NULL && i < n; i++) {
+        len += corpus_line(rng, kind, text + len);
+    }
+    *size = len;
+    return text;
+}
+
+// Malformed lines, each followed by a valid one: every malformed line
+// must be rejected as one grid, and the valid line after it still read.
+static void check_malformed(rng_t* rng, int n) {
+    char* text = malloc((size_t)2 * n * CORPUS_MAX_LINE);
+    size_t size = 0;
+    if (text == NULL) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        size += corpus_line(rng, CORPUS_MALFORMED, text + size);
+        size += corpus_line(rng, CORPUS_VALID, text + size);
+    }
+
+    sudoku_parser_t parser;
+    sudoku_grid_t grid;
+    int got;
+    long count = 0;
+    parser_init_buffer(&parser, text, size);
+    while ((got = parser_next(&parser, &grid)) != 0) {
+        int expected = count % 2 == 0 ? -1 : 1;
+        if (got != expected || (got > 0 && !check_grid_masks(&grid))) {
+            printf("parser got grid %ld of the malformed/valid mix wrong (%s)\n", count,
+                   got < 0 ? parser.error : "a valid line was misread");
+            exit(1);
+        }
+        count++;
+    }
+    if (count != 2L * n) {
+        printf("parser found %ld grids in %d malformed and %d valid lines\n", count, n, n);
+        exit(1);
+    }
+    free(text);
+}
+
+static int write_corpus(const char* path, int n, uint64_t seed) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Could not open file %s\n", path);
+        return 1;
+    }
+    rng_t rng;
+    rng_seed(&rng, seed);
+    for (int kind = 0; kind < CORPUS_NUM_KINDS; kind++) {
+        size_t size;
+        char* text = make_text(&rng, kind, n, &size);
+        if (text == NULL) {
+            printf("Out of memory\n");
+            fclose(file);
+            return 1;
+        }
+        fwrite(text, 1, size, file);
+        free(text);
+    }
+    if (fclose(file) != 0) {
+        printf("Could not write file %s\n", path);
+        return 1;
+    }
+    printf("wrote %d grids of each kind to %s\n", n, path);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int n = 1000000, m = 2000;
+    uint64_t seed = START_SEED;
+    const char* corpus_file = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:m:t:s:w:")) != -1) {
+        switch (opt) {
+        case 'n': n = atoi(optarg); break;
+        case 'm': m = atoi(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        case 'w': corpus_file = optarg; break;
+        default:
+            printf("Usage: %s [-n grids] [-m grids] [-t threads] [-s seed]\n"
+                   "       %s [-n grids] [-s seed] -w corpus_file\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (n < 1 || m < 0 || max_threads < 1) {
+        printf("Grids and threads must be positive\n");
+        return 1;
+    }
+    if (corpus_file != NULL) {
+        return write_corpus(corpus_file, n, seed);
+    }
+    if (m > n) {
+        m = n;
+    }
+
+    sudoku_grid_t* grids = malloc((size_t)n * sizeof(sudoku_grid_t));
+    unsigned char* valid = calloc(n, 1); // touched now, not in the first run
+    if (grids == NULL || valid == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    rng_t rng;
+    rng_seed(&rng, seed);
+
+    check_malformed(&rng, n < 100000 ? n : 100000);
+
+    printf("%d grids of each kind, up to %d threads\n", n, max_threads);
+    printf("Kind         | Validator   | Threads | latency ns | grids/sec    "
+           "| speedup  | efficiency\n");
+    for (int kind = 0; kind < CORPUS_NUM_KINDS; kind++) {
+        size_t size;
+        char* text = make_text(&rng, kind, n, &size);
+        if (text == NULL) {
+            printf("Out of memory\n");
+            return 1;
+        }
+
+        // parse it back, the way the validators read their input
+        sudoku_parser_t parser;
+        sudoku_grid_t spare; // for any grids past n, which would be a bug
+        int parsed = 0, rejected = 0, got;
+        parser_init_buffer(&parser, text, size);
+        double start = now_sec();
+        while ((got = parser_next(&parser, parsed < n ? &grids[parsed] : &spare)) != 0) {
+            if (got < 0) {
+                rejected++;
+            } else {
+                parsed++;
+            }
+        }
+        double elapsed = now_sec() - start;
+        free(text);
+        if (parsed + rejected != n || rejected != (kind == CORPUS_MALFORMED ? n : 0)) {
+            printf("parser read %d and rejected %d of %d \"%s\" grids\n", parsed, rejected,
+                   n, corpus_kind_name(kind));
+            return 1;
+        }
+        printf("%-12s | %-11s | %7d | %10.1f | %12.0f |          |\n", corpus_kind_name(kind),
+               "parser", 1, elapsed * 1e9 / n, n / elapsed);
+        if (kind == CORPUS_MALFORMED) {
+            continue;
+        }
+
+        double single = run(check_grid, grids, valid, n, 1);
+        expect("single pass", kind, valid, n);
+        double base = single;
+        print_row(kind, "single pass", 1, n, single, base);
+        for (int t = 2; t / 2 < max_threads; t *= 2) {
+            int threads = t < max_threads ? t : max_threads;
+            elapsed = run(check_grid, grids, valid, n, threads);
+            expect("single pass", kind, valid, n);
+            print_row(kind, "single pass", threads, n, elapsed, base);
+        }
+
+        base = run(check_grid_masks, grids, valid, n, 1);
+        expect("bitmask", kind, valid, n);
+        print_row(kind, "bitmask", 1, n, base, base);
+        for (int t = 2; t / 2 < max_threads; t *= 2) {
+            int threads = t < max_threads ? t : max_threads;
+            elapsed = run(check_grid_masks, grids, valid, n, threads);
+            expect("bitmask", kind, valid, n);
+            print_row(kind, "bitmask", threads, n, elapsed, base);
+        }
+
+        // one grid at a time, each on 11 new threads
+        if (m > 0) {
+            elapsed = run(check_grid_threads, grids, valid, m, 1);
+            expect("11 threads", kind, valid, m);
+            printf("%-12s | %-11s | %7d | %10.1f | %12.0f | %7.4fx | %5.3f%%\n",
+                   corpus_kind_name(kind), "11 threads", NUM_THREADS, elapsed * 1e9 / m,
+                   m / elapsed, single / n / (elapsed / m),
+                   100 * single / n / (elapsed / m) / NUM_THREADS);
+        }
+    }
+
+    free(valid);
+    free(grids);
+    return 0;
+}
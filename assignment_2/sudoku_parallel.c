@@ -0,0 +1,265 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rng.h"
+#include "sudoku_parallel.h"
+#include "sudoku_solver.h"
+
+#define START_SEED 11 // arbitrary value to seed the victim choice
+#define PUBLISH_BATCH 1024 // solutions a worker counts before publishing them
+
+typedef struct {
+    solver_board_t board;
+    int depth;  // guesses made to reach this board
+} task_t;
+
+// A worker's tasks, oldest at head.  The owner pushes and pops at tail,
+// thieves take from head; one mutex covers both, which is cheap here
+// since tasks only come from the shallow part of the tree.
+typedef struct {
+    pthread_mutex_t mutex;
+    task_t* tasks;
+    int head, tail, capacity;
+} deque_t;
+
+typedef struct worker worker_t;
+
+typedef struct {
+    worker_t* workers;
+    int num_workers;
+    int split_depth;
+    long limit;
+    atomic_long pending;    // tasks pushed but not yet finished
+    atomic_long solutions;  // published by the workers
+} pool_t;
+
+struct worker {
+    _Alignas(64) deque_t deque;
+    pool_t* pool;
+    rng_t* rng;
+    long nodes, tasks, steals;
+    long found;            // solutions this worker found
+    long unpublished;      // of those, not yet added to pool->solutions
+    sudoku_grid_t solution; // the first of them
+    pthread_t thread;
+};
+
+static void deque_init(deque_t* q) {
+    pthread_mutex_init(&q->mutex, NULL);
+    q->tasks = NULL;
+    q->head = q->tail = q->capacity = 0;
+}
+
+static void deque_destroy(deque_t* q) {
+    pthread_mutex_destroy(&q->mutex);
+    free(q->tasks);
+}
+
+static int deque_push(deque_t* q, const task_t* task) {
+    pthread_mutex_lock(&q->mutex);
+    if (q->tail == q->capacity) {
+        if (q->head > 0) { // room at the front: slide down
+            memmove(q->tasks, q->tasks + q->head, (q->tail - q->head) * sizeof(task_t));
+            q->tail -= q->head;
+            q->head = 0;
+        } else {
+            int capacity = q->capacity ? 2 * q->capacity : 64;
+            task_t* tasks = realloc(q->tasks, capacity * sizeof(task_t));
+            if (tasks == NULL) {
+                pthread_mutex_unlock(&q->mutex);
+                return 0;
+            }
+            q->tasks = tasks;
+            q->capacity = capacity;
+        }
+    }
+    q->tasks[q->tail++] = *task;
+    pthread_mutex_unlock(&q->mutex);
+    return 1;
+}
+
+// Takes the newest task (owner) or the oldest (thief).
+static int deque_take(deque_t* q, task_t* task, int oldest) {
+    int got = 0;
+    pthread_mutex_lock(&q->mutex);
+    if (q->head < q->tail) {
+        *task = oldest ? q->tasks[q->head++] : q->tasks[--q->tail];
+        got = 1;
+    }
+    pthread_mutex_unlock(&q->mutex);
+    return got;
+}
+
+static void publish(worker_t* self) {
+    if (self->unpublished > 0) {
+        atomic_fetch_add(&self->pool->solutions, self->unpublished);
+        self->unpublished = 0;
+    }
+}
+
+static int enough(worker_t* self) {
+    return atomic_load_explicit(&self->pool->solutions, memory_order_relaxed) +
+           self->unpublished >= self->pool->limit;
+}
+
+// Searches the whole subtree below board on this worker, stopping as
+// soon as the pool has enough solutions.
+static void search_here(worker_t* self, const solver_board_t* board) {
+    self->nodes++;
+    int cell = solver_choose(board);
+    if (cell < 0) {
+        if (self->found++ == 0) {
+            solver_grid(board, &self->solution);
+        }
+        if (++self->unpublished == PUBLISH_BATCH) {
+            publish(self);
+        }
+        return;
+    }
+    unsigned cand = solver_candidates(board, cell);
+    while (cand && !enough(self)) {
+        int digit = __builtin_ctz(cand) + 1;
+        cand &= cand - 1;
+
+        solver_board_t child;
+        if (solver_try(board, cell, digit, &child)) {
+            search_here(self, &child);
+        }
+    }
+}
+
+// Runs one task: near the root its children become new tasks, deeper
+// its whole subtree is searched here.
+static void run_task(worker_t* self, task_t* task) {
+    pool_t* pool = self->pool;
+    int cell = solver_choose(&task->board);
+
+    if (enough(self)) {
+        return; // drop the rest of the tree
+    }
+    if (task->depth >= pool->split_depth || cell < 0) {
+        search_here(self, &task->board);
+        publish(self);
+        return;
+    }
+
+    self->nodes++;
+    unsigned cand = solver_candidates(&task->board, cell);
+    task_t child = { .depth = task->depth + 1 };
+    while (cand) {
+        int digit = __builtin_ctz(cand) + 1;
+        cand &= cand - 1;
+        if (!solver_try(&task->board, cell, digit, &child.board)) {
+            continue;
+        }
+        atomic_fetch_add(&pool->pending, 1);
+        if (!deque_push(&self->deque, &child)) {
+            // out of memory: search it here instead
+            search_here(self, &child.board);
+            publish(self);
+            atomic_fetch_sub(&pool->pending, 1);
+        }
+    }
+}
+
+static void* worker_main(void* param) {
+    worker_t* self = (worker_t*)param;
+    pool_t* pool = self->pool;
+    task_t task;
+
+    while (1) {
+        int got = deque_take(&self->deque, &task, 0);
+        for (int k = 0; !got && k < pool->num_workers - 1; k++) {
+            int victim = (int)rng_below(self->rng, pool->num_workers);
+            if (&pool->workers[victim] != self &&
+                deque_take(&pool->workers[victim].deque, &task, 1)) {
+                got = 1;
+                self->steals++;
+            }
+        }
+        if (!got) {
+            if (atomic_load(&pool->pending) == 0) {
+                return NULL; // every task is finished, and none can appear
+            }
+            sched_yield();
+            continue;
+        }
+        run_task(self, &task);
+        self->tasks++;
+        atomic_fetch_sub(&pool->pending, 1);
+    }
+}
+
+long parallel_count(const sudoku_grid_t* puzzle, long limit, int num_threads,
+                    int split_depth, sudoku_grid_t* solution, parallel_stats_t* stats) {
+    pool_t pool;
+    task_t root = { .depth = 0 };
+
+    memset(stats, 0, sizeof(*stats));
+    if (!solver_init(&root.board, puzzle)) {
+        stats->nodes = 1;
+        return 0;
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    pool.num_workers = num_threads;
+    pool.split_depth = split_depth;
+    pool.limit = limit;
+    atomic_init(&pool.pending, 1);
+    atomic_init(&pool.solutions, 0);
+    pool.workers = aligned_alloc(64, num_threads * sizeof(worker_t));
+    rng_t* rngs = rng_streams(num_threads, START_SEED);
+    if (pool.workers == NULL || rngs == NULL) {
+        free(rngs);
+        free(pool.workers);
+        return -1;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        worker_t* w = &pool.workers[i];
+        deque_init(&w->deque);
+        w->pool = &pool;
+        w->rng = &rngs[i];
+        w->nodes = w->tasks = w->steals = 0;
+        w->found = w->unpublished = 0;
+    }
+    if (!deque_push(&pool.workers[0].deque, &root)) {
+        // no task would ever finish, and pending would stay at 1
+        for (int i = 0; i < num_threads; i++) {
+            deque_destroy(&pool.workers[i].deque);
+        }
+        free(rngs);
+        free(pool.workers);
+        return -1;
+    }
+
+    for (int i = 1; i < num_threads; i++) {
+        pthread_create(&pool.workers[i].thread, NULL, worker_main, &pool.workers[i]);
+    }
+    worker_main(&pool.workers[0]); // the caller is worker 0
+    for (int i = 1; i < num_threads; i++) {
+        pthread_join(pool.workers[i].thread, NULL);
+    }
+
+    int have_solution = 0;
+    for (int i = 0; i < num_threads; i++) {
+        worker_t* w = &pool.workers[i];
+        stats->nodes += w->nodes;
+        stats->tasks += w->tasks;
+        stats->steals += w->steals;
+        if (w->found > 0 && solution != NULL && !have_solution) {
+            *solution = w->solution;
+            have_solution = 1;
+        }
+        deque_destroy(&w->deque);
+    }
+    long count = atomic_load(&pool.solutions);
+    stats->solutions = count < limit ? count : limit;
+    free(rngs);
+    free(pool.workers);
+    return stats->solutions;
+}
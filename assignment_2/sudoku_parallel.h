@@ -0,0 +1,30 @@
+#ifndef sudoku_parallel_h
+#define sudoku_parallel_h
+
+#include "sudoku_check.h"
+
+// Parallel search for puzzles with a big search tree: very hard ones,
+// and counting every solution of a puzzle with many.  The top of the
+// tree is split into tasks, one per search node down to split_depth
+// guesses, which run on a pool of workers.  Each worker keeps its own
+// deque: it takes its newest task (depth first, good locality) and,
+// when out of work, steals the oldest task of a random other worker
+// (near the root, so a big piece of the tree).  Below split_depth a
+// task is searched on its own with solver_count().
+
+typedef struct {
+    long solutions;  // found, at most the limit
+    long nodes;      // search nodes visited by all workers
+    long tasks;      // tasks run
+    long steals;     // tasks taken from another worker's deque
+} parallel_stats_t;
+
+// Counts the solutions of puzzle, stopping at about limit of them (a
+// worker already searching may go a little past it; the count
+// returned is capped at limit).  The first solution found goes to
+// solution, if not NULL.  Returns -1 if memory runs out before the
+// search starts.
+long parallel_count(const sudoku_grid_t* puzzle, long limit, int num_threads,
+                    int split_depth, sudoku_grid_t* solution, parallel_stats_t* stats);
+
+#endif // sudoku_parallel_h
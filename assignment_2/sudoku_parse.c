@@ -0,0 +1,248 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "sudoku_parse.h"
+
+// Reads all of fd into one malloc()ed buffer (for pipes and terminals,
+// which can't be mapped).
+static int read_all(sudoku_parser_t* parser, int fd) {
+    size_t capacity = 1 << 20, size = 0;
+    char* data = malloc(capacity);
+
+    while (data != NULL) {
+        if (size == capacity) {
+            char* bigger = realloc(data, capacity *= 2);
+            if (bigger == NULL) {
+                break;
+            }
+            data = bigger;
+        }
+        ssize_t got = read(fd, data + size, capacity - size);
+        if (got < 0) {
+            break;
+        }
+        if (got == 0) {
+            parser->data = data;
+            parser->size = size;
+            return 0;
+        }
+        size += got;
+    }
+    free(data);
+    snprintf(parser->error, sizeof(parser->error), "could not read input");
+    return -1;
+}
+
+int parser_open(sudoku_parser_t* parser, const char* path) {
+    int fd = 0;
+    struct stat st;
+
+    memset(parser, 0, sizeof(*parser));
+    parser->line = 1;
+    if (path != NULL && strcmp(path, "-") != 0) {
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            snprintf(parser->error, sizeof(parser->error), "could not open file %s", path);
+            return -1;
+        }
+    }
+
+    int result = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size > 0) {
+            void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                snprintf(parser->error, sizeof(parser->error), "could not map input");
+                result = -1;
+            } else {
+                madvise(data, st.st_size, MADV_SEQUENTIAL);
+                parser->data = data;
+                parser->size = st.st_size;
+                parser->mapped = 1;
+            }
+        }
+    } else {
+        result = read_all(parser, fd);
+    }
+
+    if (fd != 0) {
+        close(fd);
+    }
+    return result;
+}
+
+void parser_init_buffer(sudoku_parser_t* parser, const char* data, size_t size) {
+    memset(parser, 0, sizeof(*parser));
+    parser->data = data;
+    parser->size = size;
+    parser->line = 1;
+    parser->mapped = -1; // not ours to release
+}
+
+void parser_close(sudoku_parser_t* parser) {
+    if (parser->mapped == 1) {
+        munmap((void*)parser->data, parser->size);
+    } else if (parser->mapped == 0) {
+        free((void*)parser->data);
+    }
+    parser->data = NULL;
+    parser->size = 0;
+}
+
+#define MAX_NUMBER_DIGITS 3 // a cell of the numbers format is 0..255
+
+static const unsigned char space_table[256] = {
+    ['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1, [' '] = 1,
+};
+
+static inline int is_space(char c) {
+    return space_table[(unsigned char)c];
+}
+
+static void skip_space(sudoku_parser_t* parser) {
+    while (parser->pos < parser->size && is_space(parser->data[parser->pos])) {
+        parser->line += parser->data[parser->pos] == '\n';
+        parser->pos++;
+    }
+}
+
+// Reports a malformed grid at "pos" and moves on to the next line.
+static int fail(sudoku_parser_t* parser, const char* what, size_t pos) {
+    size_t line_start = pos;
+    while (line_start > 0 && parser->data[line_start - 1] != '\n') {
+        line_start--;
+    }
+    snprintf(parser->error, sizeof(parser->error), "line %ld, column %zu: %s",
+             parser->line, pos - line_start + 1, what);
+    parser->pos = pos;
+    while (parser->pos < parser->size && parser->data[parser->pos] != '\n') {
+        parser->pos++;
+    }
+    return -1;
+}
+
+// Converts 81 characters, digits or '.', into cells.  Returns -1 if all
+// are fine, otherwise the index of the first bad character.
+static int parse_cells(const char* text, sudoku_grid_t* grid) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i dot = _mm_set1_epi8('.');
+    const __m128i nine = _mm_set1_epi8(9);
+    for (; i + 16 <= PUZZLE_CELLS; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i digit = _mm_sub_epi8(v, zero);
+        __m128i is_dot = _mm_cmpeq_epi8(v, dot);
+        __m128i is_digit = _mm_cmpeq_epi8(_mm_max_epu8(digit, nine), nine);
+        int good = _mm_movemask_epi8(_mm_or_si128(is_digit, is_dot));
+        if (good != 0xffff) {
+            return i + __builtin_ctz(~good);
+        }
+        _mm_storeu_si128((__m128i*)&grid->cell[i], _mm_andnot_si128(is_dot, digit));
+    }
+#endif
+    for (; i < PUZZLE_CELLS; i++) {
+        unsigned char digit = text[i] - '0';
+        if (text[i] == '.') {
+            digit = 0;
+        } else if (digit > 9) {
+            return i;
+        }
+        grid->cell[i] = digit;
+    }
+    return -1;
+}
+
+int parser_next(sudoku_parser_t* parser, sudoku_grid_t* grid) {
+    const char* data = parser->data;
+    size_t size = parser->size;
+
+    skip_space(parser);
+    if (parser->pos >= size) {
+        return 0;
+    }
+
+    // A first token of 81 characters means the one-line format.  Try
+    // that first: a short token fails on the space after it.
+    size_t start = parser->pos;
+    if (size - start >= PUZZLE_CELLS) {
+        int bad = parse_cells(data + start, grid);
+        if (bad < 0) {
+            if (start + PUZZLE_CELLS < size && !is_space(data[start + PUZZLE_CELLS])) {
+                return fail(parser, "more than 81 cells on one line", start);
+            }
+            parser->pos += PUZZLE_CELLS;
+            return 1;
+        }
+    }
+
+    // A token longer than any number, or with a '.', is a one-line grid
+    // that is wrong: report it, rather than read it (and the lines after
+    // it) as whitespace separated numbers.
+    size_t len = 0;
+    while (start + len < size && !is_space(data[start + len])) {
+        len++;
+    }
+    if (len > MAX_NUMBER_DIGITS || memchr(data + start, '.', len) != NULL) {
+        for (size_t i = 0; i < len && i < PUZZLE_CELLS; i++) {
+            if (data[start + i] != '.' && (unsigned char)(data[start + i] - '0') > 9) {
+                return fail(parser, "cell is not a digit or '.'", start + i);
+            }
+        }
+        return fail(parser, "fewer than 81 cells on one line", start + len);
+    }
+
+    // Otherwise 81 whitespace separated numbers, over any number of lines.
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        size_t pos = parser->pos;
+        while (pos < size && is_space(data[pos])) {
+            parser->line += data[pos] == '\n';
+            pos++;
+        }
+        if (pos >= size) {
+            parser->pos = pos;
+            snprintf(parser->error, sizeof(parser->error),
+                     "line %ld: input ends after %d of 81 numbers", parser->line, i);
+            return -1;
+        }
+        // the common case: one digit and a separator
+        unsigned char digit = data[pos] - '0';
+        if (digit <= 9 && pos + 1 < size && is_space(data[pos + 1])) {
+            grid->cell[i] = digit;
+            parser->pos = pos + 1;
+            continue;
+        }
+        size_t first = pos;
+        unsigned value = 0;
+        while (pos < size && (unsigned char)(data[pos] - '0') <= 9 &&
+               pos - first < MAX_NUMBER_DIGITS + 1) {
+            value = value * 10 + (data[pos] - '0');
+            pos++;
+        }
+        if (pos - first > MAX_NUMBER_DIGITS) {
+            // a one-line grid, most likely: this grid ends short, and the
+            // next call starts over at the long token
+            fail(parser, "fewer than 81 numbers before a line of cells", first);
+            parser->pos = first;
+            return -1;
+        }
+        if (pos == first || (pos < size && !is_space(data[pos]))) {
+            return fail(parser, "expected a number", pos);
+        }
+        if (value > 255) {
+            return fail(parser, "number is larger than 255", first);
+        }
+        grid->cell[i] = value;
+        parser->pos = pos;
+    }
+    return 1;
+}
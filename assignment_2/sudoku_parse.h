@@ -0,0 +1,40 @@
+#ifndef sudoku_parse_h
+#define sudoku_parse_h
+
+#include <stddef.h>
+
+#include "sudoku_check.h"
+
+// Zero-copy reader for files of 9x9 grids.  The input is mapped into
+// memory (or, for a pipe, read into one buffer) and parsed straight
+// into packed byte grids.  Two formats are accepted, and may be mixed:
+//
+//   * 81 whitespace separated numbers per grid (like correct_sudoku),
+//     over any number of lines, each of at most 3 digits and 255
+//   * one grid per line of exactly 81 characters, "0" or "." for an
+//     empty cell (the usual puzzle-corpus format)
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t pos;        // next byte to parse
+    long line;         // line number of "pos", from 1
+    int mapped;        // 1 if data is mmap()ed, 0 if malloc()ed
+    char error[128];   // what was wrong with the last malformed grid
+} sudoku_parser_t;
+
+// Opens "path" (NULL or "-" for stdin).  Returns 0, or -1 with a
+// message in parser->error.
+int parser_open(sudoku_parser_t* parser, const char* path);
+
+// Parses grids from memory the caller owns (and keeps alive).
+void parser_init_buffer(sudoku_parser_t* parser, const char* data, size_t size);
+
+void parser_close(sudoku_parser_t* parser);
+
+// Returns 1 with the next grid, 0 at the end of the input, or -1 for a
+// malformed grid, described in parser->error.  After an error parsing
+// resumes on the next line, except when a grid of numbers runs into a
+// line of cells: that line is then read as the next grid.
+int parser_next(sudoku_parser_t* parser, sudoku_grid_t* grid);
+
+#endif // sudoku_parse_h
@@ -0,0 +1,131 @@
+// Sudoku solver: solves every puzzle in a file (or stdin), in either
+// format sudoku_parse accepts, and prints each solution as one line of
+// 81 digits.  The summary on stderr gives the throughput and the
+// average search effort.  Every solution is checked before it counts.
+//
+// to compile enter:
+//    cc -Wall -O2 -march=native sudoku_solve.c sudoku_solver.c sudoku_parse.c sudoku_check.c
+// usage:
+//    ./a.out [-q] [-u] [-r repeats] [file]     (no file or "-" reads stdin)
+//    ./a.out -q -r 100 hard_puzzles            (benchmark on the hard corpus)
+//       -q  don't print the solutions
+//       -u  also check that each solution is unique
+//       -r  solve the whole file this many times (for timing)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sudoku_check.h"
+#include "sudoku_parse.h"
+#include "sudoku_solver.h"
+
+// A solution must be valid and keep every given of the puzzle.
+static int solves(const sudoku_grid_t* puzzle, const sudoku_grid_t* solution) {
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        if (puzzle->cell[i] != 0 && puzzle->cell[i] != solution->cell[i]) {
+            return 0;
+        }
+    }
+    return check_grid_masks(solution);
+}
+
+int main(int argc, char* argv[]) {
+    int quiet = 0, repeats = 1;
+    long limit = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qur:")) != -1) {
+        switch (opt) {
+        case 'q': quiet = 1; break;
+        case 'u': limit = 2; break;
+        case 'r': repeats = atoi(optarg); break;
+        default:
+            printf("Usage: %s [-q] [-u] [-r repeats] [sudoku_puzzle_file]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeats < 1) {
+        repeats = 1;
+    }
+
+    // parse everything up front, so the timing is the solver's alone
+    sudoku_parser_t parser;
+    if (parser_open(&parser, optind < argc ? argv[optind] : NULL) != 0) {
+        printf("%s\n", parser.error);
+        return 1;
+    }
+    int n = 0, capacity = 1024, got;
+    sudoku_grid_t* puzzles = malloc(capacity * sizeof(sudoku_grid_t));
+    while (puzzles != NULL && (got = parser_next(&parser, &puzzles[n])) != 0) {
+        if (got < 0) {
+            fprintf(stderr, "puzzle %d: %s\n", n, parser.error);
+            continue;
+        }
+        if (++n == capacity) {
+            sudoku_grid_t* bigger = realloc(puzzles, (capacity *= 2) * sizeof(sudoku_grid_t));
+            if (bigger == NULL) {
+                break;
+            }
+            puzzles = bigger;
+        }
+    }
+    parser_close(&parser);
+    sudoku_grid_t* solutions = malloc((n + 1) * sizeof(sudoku_grid_t));
+    long* counts = malloc((n + 1) * sizeof(long));
+    if (puzzles == NULL || solutions == NULL || counts == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    solver_stats_t stats = {0, 0};
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int k = 0; k < repeats; k++) {
+        for (int i = 0; i < n; i++) {
+            counts[i] = sudoku_solve(&puzzles[i], &solutions[i], limit, &stats);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    long solved = 0, unique = 0, wrong = 0;
+    for (int i = 0; i < n; i++) {
+        if (counts[i] > 0 && !solves(&puzzles[i], &solutions[i])) {
+            printf("puzzle %d: solver returned a wrong solution\n", i);
+            wrong++;
+            continue;
+        }
+        solved += counts[i] > 0;
+        unique += counts[i] == 1;
+        if (quiet) {
+            continue;
+        }
+        if (counts[i] == 0) {
+            printf("no solution\n");
+            continue;
+        }
+        for (int c = 0; c < PUZZLE_CELLS; c++) {
+            putchar('0' + solutions[i].cell[c]);
+        }
+        printf(limit > 1 && counts[i] > 1 ? " (not unique)\n" : "\n");
+    }
+
+    long total = (long)n * repeats;
+    fprintf(stderr, "%d puzzles: %ld solved", n, solved);
+    if (limit > 1) {
+        fprintf(stderr, " (%ld unique)", unique);
+    }
+    fprintf(stderr, ", %.3f s for %d pass(es), %.0f puzzles/sec, %.1f us/puzzle, "
+            "%.1f nodes and %.1f guesses per puzzle\n", elapsed, repeats,
+            elapsed > 0 ? total / elapsed : 0.0, total ? elapsed * 1e6 / total : 0.0,
+            total ? (double)stats.nodes / total : 0.0,
+            total ? (double)stats.guesses / total : 0.0);
+
+    free(counts);
+    free(solutions);
+    free(puzzles);
+    return wrong ? 1 : 0;
+}
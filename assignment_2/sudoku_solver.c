@@ -0,0 +1,443 @@
+#include <string.h>
+
+#include "sudoku_solver.h"
+
+#define NUM_BANDS 3
+#define BAND_CELLS 27
+#define BAND_ALL  0x7ffffff // every cell of a band
+#define BAND_ROW  0x1ff     // first row of a band
+#define BAND_COL  0x40201   // first column of a band (bits 0, 9 and 18)
+#define BAND_BOX  0x1c0e07  // first box of a band
+
+// For each cell, its 20 peers (same row, column or box), by band.
+static const uint32_t peer_mask[PUZZLE_CELLS][NUM_BANDS] = {
+    {0x01c0ffe, 0x0040201, 0x0040201},  // row 0
+    {0x01c0ffd, 0x0080402, 0x0080402},
+    {0x01c0ffb, 0x0100804, 0x0100804},
+    {0x0e071f7, 0x0201008, 0x0201008},
+    {0x0e071ef, 0x0402010, 0x0402010},
+    {0x0e071df, 0x0804020, 0x0804020},
+    {0x70381bf, 0x1008040, 0x1008040},
+    {0x703817f, 0x2010080, 0x2010080},
+    {0x70380ff, 0x4020100, 0x4020100},
+    {0x01ffc07, 0x0040201, 0x0040201},  // row 1
+    {0x01ffa07, 0x0080402, 0x0080402},
+    {0x01ff607, 0x0100804, 0x0100804},
+    {0x0e3ee38, 0x0201008, 0x0201008},
+    {0x0e3de38, 0x0402010, 0x0402010},
+    {0x0e3be38, 0x0804020, 0x0804020},
+    {0x7037fc0, 0x1008040, 0x1008040},
+    {0x702ffc0, 0x2010080, 0x2010080},
+    {0x701ffc0, 0x4020100, 0x4020100},
+    {0x7f80e07, 0x0040201, 0x0040201},  // row 2
+    {0x7f40e07, 0x0080402, 0x0080402},
+    {0x7ec0e07, 0x0100804, 0x0100804},
+    {0x7dc7038, 0x0201008, 0x0201008},
+    {0x7bc7038, 0x0402010, 0x0402010},
+    {0x77c7038, 0x0804020, 0x0804020},
+    {0x6ff81c0, 0x1008040, 0x1008040},
+    {0x5ff81c0, 0x2010080, 0x2010080},
+    {0x3ff81c0, 0x4020100, 0x4020100},
+    {0x0040201, 0x01c0ffe, 0x0040201},  // row 3
+    {0x0080402, 0x01c0ffd, 0x0080402},
+    {0x0100804, 0x01c0ffb, 0x0100804},
+    {0x0201008, 0x0e071f7, 0x0201008},
+    {0x0402010, 0x0e071ef, 0x0402010},
+    {0x0804020, 0x0e071df, 0x0804020},
+    {0x1008040, 0x70381bf, 0x1008040},
+    {0x2010080, 0x703817f, 0x2010080},
+    {0x4020100, 0x70380ff, 0x4020100},
+    {0x0040201, 0x01ffc07, 0x0040201},  // row 4
+    {0x0080402, 0x01ffa07, 0x0080402},
+    {0x0100804, 0x01ff607, 0x0100804},
+    {0x0201008, 0x0e3ee38, 0x0201008},
+    {0x0402010, 0x0e3de38, 0x0402010},
+    {0x0804020, 0x0e3be38, 0x0804020},
+    {0x1008040, 0x7037fc0, 0x1008040},
+    {0x2010080, 0x702ffc0, 0x2010080},
+    {0x4020100, 0x701ffc0, 0x4020100},
+    {0x0040201, 0x7f80e07, 0x0040201},  // row 5
+    {0x0080402, 0x7f40e07, 0x0080402},
+    {0x0100804, 0x7ec0e07, 0x0100804},
+    {0x0201008, 0x7dc7038, 0x0201008},
+    {0x0402010, 0x7bc7038, 0x0402010},
+    {0x0804020, 0x77c7038, 0x0804020},
+    {0x1008040, 0x6ff81c0, 0x1008040},
+    {0x2010080, 0x5ff81c0, 0x2010080},
+    {0x4020100, 0x3ff81c0, 0x4020100},
+    {0x0040201, 0x0040201, 0x01c0ffe},  // row 6
+    {0x0080402, 0x0080402, 0x01c0ffd},
+    {0x0100804, 0x0100804, 0x01c0ffb},
+    {0x0201008, 0x0201008, 0x0e071f7},
+    {0x0402010, 0x0402010, 0x0e071ef},
+    {0x0804020, 0x0804020, 0x0e071df},
+    {0x1008040, 0x1008040, 0x70381bf},
+    {0x2010080, 0x2010080, 0x703817f},
+    {0x4020100, 0x4020100, 0x70380ff},
+    {0x0040201, 0x0040201, 0x01ffc07},  // row 7
+    {0x0080402, 0x0080402, 0x01ffa07},
+    {0x0100804, 0x0100804, 0x01ff607},
+    {0x0201008, 0x0201008, 0x0e3ee38},
+    {0x0402010, 0x0402010, 0x0e3de38},
+    {0x0804020, 0x0804020, 0x0e3be38},
+    {0x1008040, 0x1008040, 0x7037fc0},
+    {0x2010080, 0x2010080, 0x702ffc0},
+    {0x4020100, 0x4020100, 0x701ffc0},
+    {0x0040201, 0x0040201, 0x7f80e07},  // row 8
+    {0x0080402, 0x0080402, 0x7f40e07},
+    {0x0100804, 0x0100804, 0x7ec0e07},
+    {0x0201008, 0x0201008, 0x7dc7038},
+    {0x0402010, 0x0402010, 0x7bc7038},
+    {0x0804020, 0x0804020, 0x77c7038},
+    {0x1008040, 0x1008040, 0x6ff81c0},
+    {0x2010080, 0x2010080, 0x5ff81c0},
+    {0x4020100, 0x4020100, 0x3ff81c0},
+};
+
+static inline int one_bit(uint32_t x) {
+    return (x & (x - 1)) == 0;
+}
+
+// Places digit d (0-8) at cell i: clears the cell from every other
+// digit, and the peers of the cell from d.  Returns 0 if d can't go
+// there.
+static int place(solver_board_t* board, int i, int d) {
+    const int band = i / BAND_CELLS;
+    const uint32_t bit = 1u << (i % BAND_CELLS);
+    if (!(board->digit[d][band] & bit)) {
+        return 0;
+    }
+    for (int e = 0; e < PUZZLE_SIZE; e++) {
+        board->digit[e][band] &= ~bit;
+    }
+    for (int b = 0; b < NUM_BANDS; b++) {
+        board->digit[d][b] &= ~peer_mask[i][b];
+    }
+    board->digit[d][band] |= bit;
+    board->open[band] &= ~bit;
+    return 1;
+}
+
+// Within a band, the 9 triplets of cells where a row meets a box,
+// indexed by row * 3 + box, are bits 3 * t to 3 * t + 2 of the band.
+// band_keep[used] is the mask of triplets a digit may keep, given the
+// set of triplets it now uses: a box using one row only takes the digit
+// out of the rest of that row, and a row using one box only takes it
+// out of the rest of that box (locked candidates), applied until
+// neither rule changes anything.
+static uint32_t band_keep[512];
+
+// For the 3 columns of a box: the columns a digit must stay in (all of
+// them unless some is confined to this box), and the columns confined
+// to this box if the box uses just one.
+static const uint32_t keep3[8] = {7, 1, 2, 3, 4, 5, 6, 7};
+static const uint32_t only3[8] = {0, 1, 2, 0, 4, 0, 0, 0};
+
+static void init_tables(void) __attribute__((constructor));
+
+static void init_tables(void) {
+    for (unsigned used = 0; used < 512; used++) {
+        unsigned keep = used, last;
+        do {
+            last = keep;
+            for (int j = 0; j < 3; j++) {
+                unsigned rows = (keep >> j) & 0111; // box j, in rows 0-2
+                if (rows && one_bit(rows)) {
+                    int k = __builtin_ctz(rows) / 3;
+                    keep &= ~((7u << (3 * k)) & ~(1u << (3 * k + j)));
+                }
+                unsigned boxes = (keep >> (3 * j)) & 7; // row j, in boxes 0-2
+                if (boxes && one_bit(boxes)) {
+                    keep &= ~((0111u << __builtin_ctz(boxes)) & ~(1u << (3 * j + __builtin_ctz(boxes))));
+                }
+            }
+        } while (keep != last);
+        uint32_t mask = 0;
+        for (int t = 0; t < 9; t++) {
+            if (keep & (1u << t)) {
+                mask |= 7u << (3 * t);
+            }
+        }
+        band_keep[used] = mask;
+    }
+}
+
+// The triplets a band uses, as the 9-bit index into band_keep.
+static inline unsigned triplets_used(uint32_t x) {
+    uint32_t y = (x | x >> 1 | x >> 2) & 01111111111;
+    return (y & 1) | (y >> 2 & 2) | (y >> 4 & 4) | (y >> 6 & 8) | (y >> 8 & 16) |
+           (y >> 10 & 32) | (y >> 12 & 64) | (y >> 14 & 128) | (y >> 16 & 256);
+}
+
+// Columns a band uses, as 9 bits.
+static inline uint32_t columns_used(uint32_t x) {
+    return (x | x >> 9 | x >> 18) & BAND_ROW;
+}
+
+// 9 column bits to a band mask of whole columns.
+static inline uint32_t expand_columns(uint32_t cols) {
+    return cols * BAND_COL;
+}
+
+// Applies a per-triplet table to the 3 boxes of a 9-bit column set.
+static inline uint32_t per_box(const uint32_t* table, uint32_t cols) {
+    return table[cols & 7] | table[(cols >> 3) & 7] << 3 | table[cols >> 6] << 6;
+}
+
+// Places every naked single.  Returns -1 on a contradiction, otherwise
+// whether anything was placed.
+static int naked_singles(solver_board_t* board) {
+    int changed = 0;
+    for (int band = 0; band < NUM_BANDS; band++) {
+        uint32_t once = 0, twice = 0;
+        for (int d = 0; d < PUZZLE_SIZE; d++) {
+            uint32_t m = board->digit[d][band];
+            twice |= once & m;
+            once |= m;
+        }
+        uint32_t open = board->open[band];
+        if (open & ~once) {
+            return -1; // an empty cell with no candidates
+        }
+        uint32_t singles = open & ~twice;
+        while (singles) {
+            int pos = __builtin_ctz(singles);
+            singles &= singles - 1;
+            int d = 0;
+            while (d < PUZZLE_SIZE && !(board->digit[d][band] & (1u << pos))) {
+                d++;
+            }
+            // an earlier single may have taken this cell's only digit
+            if (d == PUZZLE_SIZE || !place(board, band * BAND_CELLS + pos, d)) {
+                return -1;
+            }
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+// Hidden single and empty-unit test for one unit of a band: adds the
+// unit to *single if the digit has one place left in it, and flags
+// *none if it has no place at all.
+static inline void check_unit(uint32_t unit, uint32_t* single, int* none) {
+    *single |= one_bit(unit) ? unit : 0;
+    *none |= unit == 0;
+}
+
+// Applies locked candidates and hidden singles to digit d.  Returns -1
+// on a contradiction, otherwise whether anything changed.
+static int update_digit(solver_board_t* board, int d) {
+    uint32_t* m = board->digit[d];
+    uint32_t x[NUM_BANDS], c[NUM_BANDS];
+
+    // locked candidates inside each band, then across bands: a box
+    // using one column takes the digit out of that column in the other
+    // bands, and a column used in one band only keeps the digit out of
+    // the other columns of its box there
+    for (int b = 0; b < NUM_BANDS; b++) {
+        x[b] = m[b] & band_keep[triplets_used(m[b])];
+        c[b] = columns_used(x[b]);
+    }
+    uint32_t lock0 = per_box(only3, c[0]), lock1 = per_box(only3, c[1]);
+    uint32_t lock2 = per_box(only3, c[2]);
+    x[0] &= ~expand_columns(lock1 | lock2) & expand_columns(per_box(keep3, c[0] & ~c[1] & ~c[2]));
+    x[1] &= ~expand_columns(lock0 | lock2) & expand_columns(per_box(keep3, c[1] & ~c[0] & ~c[2]));
+    x[2] &= ~expand_columns(lock0 | lock1) & expand_columns(per_box(keep3, c[2] & ~c[0] & ~c[1]));
+    int changed = (x[0] != m[0]) | (x[1] != m[1]) | (x[2] != m[2]);
+    m[0] = x[0];
+    m[1] = x[1];
+    m[2] = x[2];
+
+    // hidden singles in rows, boxes and columns
+    uint32_t single[NUM_BANDS] = {0, 0, 0};
+    uint32_t once = 0, twice = 0;
+    int none = 0;
+    for (int b = 0; b < NUM_BANDS; b++) {
+        for (int k = 0; k < 3; k++) {
+            check_unit(x[b] & (BAND_ROW << (9 * k)), &single[b], &none);
+            check_unit(x[b] & (BAND_BOX << (3 * k)), &single[b], &none);
+        }
+        uint32_t r0 = x[b] & BAND_ROW, r1 = (x[b] >> 9) & BAND_ROW, r2 = x[b] >> 18;
+        c[b] = r0 | r1 | r2;
+        twice |= (r0 & r1) | (r0 & r2) | (r1 & r2) | (once & c[b]);
+        once |= c[b];
+    }
+    if (none || once != BAND_ROW) {
+        return -1;
+    }
+    uint32_t single_cols = expand_columns(once & ~twice);
+    for (int b = 0; b < NUM_BANDS; b++) {
+        single[b] = (single[b] | (x[b] & single_cols)) & board->open[b];
+    }
+
+    for (int b = 0; b < NUM_BANDS; b++) {
+        while (single[b]) {
+            // a second single of d in one unit fails here: the first
+            // took the cell out of d's bitboard
+            if (!place(board, b * BAND_CELLS + __builtin_ctz(single[b]), d)) {
+                return -1;
+            }
+            single[b] &= single[b] - 1;
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+// Applies the rules above until none applies.  Returns 0 on a
+// contradiction.
+static int propagate(solver_board_t* board) {
+    // each digit's bitboard when it was last updated without result:
+    // while it stays the same, updating it again finds nothing new
+    uint32_t seen[PUZZLE_SIZE][NUM_BANDS] = {{0}};
+
+    while (1) {
+        int got = naked_singles(board);
+        if (got < 0) {
+            return 0;
+        }
+        if (got == 0) {
+            for (int d = 0; d < PUZZLE_SIZE; d++) {
+                uint32_t* m = board->digit[d];
+                if (m[0] == seen[d][0] && m[1] == seen[d][1] && m[2] == seen[d][2]) {
+                    continue;
+                }
+                seen[d][0] = m[0];
+                seen[d][1] = m[1];
+                seen[d][2] = m[2];
+                int result = update_digit(board, d);
+                if (result < 0) {
+                    return 0;
+                }
+                got |= result;
+            }
+            if (got == 0) {
+                return 1;
+            }
+        }
+    }
+}
+
+int solver_init(solver_board_t* board, const sudoku_grid_t* puzzle) {
+    for (int b = 0; b < NUM_BANDS; b++) {
+        for (int d = 0; d < PUZZLE_SIZE; d++) {
+            board->digit[d][b] = BAND_ALL;
+        }
+        board->open[b] = BAND_ALL;
+    }
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        int digit = puzzle->cell[i];
+        if (digit > PUZZLE_SIZE) {
+            return 0;
+        }
+        if (digit != 0 && !place(board, i, digit - 1)) {
+            return 0;
+        }
+    }
+    return propagate(board);
+}
+
+unsigned solver_candidates(const solver_board_t* board, int cell) {
+    const int band = cell / BAND_CELLS;
+    const uint32_t bit = 1u << (cell % BAND_CELLS);
+    unsigned cand = 0;
+    if (board->open[band] & bit) {
+        for (int d = 0; d < PUZZLE_SIZE; d++) {
+            if (board->digit[d][band] & bit) {
+                cand |= 1u << d;
+            }
+        }
+    }
+    return cand;
+}
+
+void solver_grid(const solver_board_t* board, sudoku_grid_t* grid) {
+    memset(grid->cell, 0, PUZZLE_CELLS);
+    for (int d = 0; d < PUZZLE_SIZE; d++) {
+        for (int band = 0; band < NUM_BANDS; band++) {
+            uint32_t placed = board->digit[d][band] & ~board->open[band];
+            while (placed) {
+                grid->cell[band * BAND_CELLS + __builtin_ctz(placed)] = d + 1;
+                placed &= placed - 1;
+            }
+        }
+    }
+}
+
+int solver_choose(const solver_board_t* board) {
+    // a cell with two candidates is as good as it gets (propagation
+    // leaves no cell with one), and is found with bit operations
+    for (int band = 0; band < NUM_BANDS; band++) {
+        uint32_t once = 0, twice = 0, more = 0;
+        for (int d = 0; d < PUZZLE_SIZE; d++) {
+            uint32_t m = board->digit[d][band];
+            more |= twice & m;
+            twice |= once & m;
+            once |= m;
+        }
+        uint32_t pairs = board->open[band] & twice & ~more;
+        if (pairs) {
+            return band * BAND_CELLS + __builtin_ctz(pairs);
+        }
+    }
+
+    int best = -1, best_count = PUZZLE_SIZE + 1;
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        unsigned cand = solver_candidates(board, i);
+        if (cand != 0 && __builtin_popcount(cand) < best_count) {
+            best = i;
+            best_count = __builtin_popcount(cand);
+        }
+    }
+    return best;
+}
+
+int solver_try(const solver_board_t* board, int cell, int digit, solver_board_t* child) {
+    *child = *board;
+    return place(child, cell, digit - 1) && propagate(child);
+}
+
+static long search(const solver_board_t* board, long limit, sudoku_grid_t* solution,
+                   long found, solver_stats_t* stats) {
+    stats->nodes++;
+    int i = solver_choose(board);
+    if (i < 0) {
+        if (found == 0 && solution != NULL) {
+            solver_grid(board, solution);
+        }
+        return 1;
+    }
+
+    unsigned cand = solver_candidates(board, i);
+    long count = 0;
+    while (cand && found + count < limit) {
+        int digit = __builtin_ctz(cand) + 1;
+        cand &= cand - 1;
+        stats->guesses++;
+
+        solver_board_t child;
+        if (solver_try(board, i, digit, &child)) {
+            count += search(&child, limit, solution, found + count, stats);
+        }
+    }
+    return count;
+}
+
+long solver_count(const solver_board_t* board, long limit, sudoku_grid_t* solution,
+                  solver_stats_t* stats) {
+    solver_stats_t local = {0, 0};
+    return search(board, limit, solution, 0, stats != NULL ? stats : &local);
+}
+
+long sudoku_solve(const sudoku_grid_t* puzzle, sudoku_grid_t* solution, long limit,
+                  solver_stats_t* stats) {
+    solver_board_t board;
+    if (!solver_init(&board, puzzle)) {
+        if (stats != NULL) {
+            stats->nodes++;
+        }
+        return 0;
+    }
+    return solver_count(&board, limit, solution, stats);
+}
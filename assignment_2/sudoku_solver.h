@@ -0,0 +1,57 @@
+#ifndef sudoku_solver_h
+#define sudoku_solver_h
+
+#include <stdint.h>
+
+#include "sudoku_check.h"
+
+// Search state of the solver, as bitboards: for every digit, the cells
+// it may still take (or already holds).  The grid is cut into 3 bands
+// of 3 rows, 27 cells each, so a band fits in 32 bits; cell i is bit
+// i % 27 of band i / 27.  Placing a digit clears it from the 20 peers
+// of its cell.  Then cells with one candidate left (naked singles),
+// digits with one place left in a row, column or box (hidden singles)
+// and digits confined to one line of a box or one box of a line
+// (locked candidates) are applied until nothing more follows.  A board
+// is 120 bytes, so the search copies it for each guess instead of
+// undoing moves.
+typedef struct {
+    uint32_t digit[PUZZLE_SIZE][3]; // cells digit d+1 may take, by band
+    uint32_t open[3];               // cells still empty, by band
+} solver_board_t;
+
+typedef struct {
+    long nodes;    // boards the search visited
+    long guesses;  // digits tried at branching cells
+} solver_stats_t;
+
+// Sets up the board for a puzzle (0 is an empty cell) and propagates
+// the givens.  Returns 0 if the givens contradict each other, or a cell
+// holds something other than 0-9.
+int solver_init(solver_board_t* board, const sudoku_grid_t* puzzle);
+
+// The empty cell with the fewest candidates, or -1 if the board is full.
+int solver_choose(const solver_board_t* board);
+
+// Candidates of a cell, bit d-1 for digit d (0 once the cell is placed).
+unsigned solver_candidates(const solver_board_t* board, int cell);
+
+// Copies the placed digits to grid (0 for the cells still empty).
+void solver_grid(const solver_board_t* board, sudoku_grid_t* grid);
+
+// child = board with digit placed at cell, propagated.  Returns 0 if
+// that leads to a contradiction.
+int solver_try(const solver_board_t* board, int cell, int digit, solver_board_t* child);
+
+// Counts the solutions below board, stopping once limit are found.  The
+// first one goes to solution (if not NULL); stats (if not NULL) are
+// added to.
+long solver_count(const solver_board_t* board, long limit, sudoku_grid_t* solution,
+                  solver_stats_t* stats);
+
+// Solves a puzzle: returns the number of solutions found, up to limit
+// (1 to just solve it, 2 to also know whether the solution is unique).
+long sudoku_solve(const sudoku_grid_t* puzzle, sudoku_grid_t* solution, long limit,
+                  solver_stats_t* stats);
+
+#endif // sudoku_solver_h
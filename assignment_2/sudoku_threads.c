@@ -0,0 +1,85 @@
+#include <pthread.h>
+
+#include "sudoku_threads.h"
+#include "thread_launch.h"
+
+typedef struct {
+    int row;
+    int col;
+    const sudoku_grid_t* grid;
+    int* valid; // this thread's entry of the result array
+} params_t;
+
+// Validates every row
+static void* validate_row(void* param) {
+    params_t* params = (params_t*)param;
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        if (!check_row(params->grid, i)) {
+            return NULL; // Duplicate found
+        }
+    }
+    *params->valid = 1; // Indicates rows are valid
+    return NULL;
+}
+
+// Validates every column
+static void* validate_col(void* param) {
+    params_t* params = (params_t*)param;
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        if (!check_col(params->grid, i)) {
+            return NULL;
+        }
+    }
+    *params->valid = 1; // Indicates columns are valid
+    return NULL;
+}
+
+// Validates a single 3x3 subgrid
+static void* validate_subgrid(void* param) {
+    params_t* params = (params_t*)param;
+    if (check_subgrid(params->grid, params->row, params->col)) {
+        *params->valid = 1;
+    }
+    return NULL;
+}
+
+// Starts thread number index (placed as THREAD_PLACEMENT says), or runs
+// fn right here if no thread can be created (then there is nothing to
+// join, and *joinable is 0).
+static void start(pthread_t* thread, int index, int* joinable, void* (*fn)(void*),
+                  params_t* params) {
+    *joinable = thread_launch(thread, index, fn, params) == 0;
+    if (!*joinable) {
+        fn(params);
+    }
+}
+
+int check_grid_threads(const sudoku_grid_t* grid) {
+    pthread_t threads[NUM_THREADS];
+    int joinable[NUM_THREADS];
+    params_t params[NUM_THREADS];
+    int validation[NUM_THREADS] = {0}; // Array to hold results from threads
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        params[i].grid = grid;
+        params[i].valid = &validation[i];
+    }
+    start(&threads[0], 0, &joinable[0], validate_row, &params[0]);
+    start(&threads[1], 1, &joinable[1], validate_col, &params[1]);
+    // threads 2-10 take the subgrids row by row
+    for (int i = 0; i < PUZZLE_SIZE; i++) {
+        params[2 + i].row = i / 3 * 3;
+        params[2 + i].col = i % 3 * 3;
+        start(&threads[2 + i], 2 + i, &joinable[2 + i], validate_subgrid, &params[2 + i]);
+    }
+
+    // Join threads
+    int valid = 1;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        if (joinable[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        valid &= validation[i];
+    }
+    return valid;
+}
@@ -0,0 +1,15 @@
+#ifndef sudoku_threads_h
+#define sudoku_threads_h
+
+#include "sudoku_check.h"
+
+#define NUM_THREADS 11
+
+// The assignment's validator as a function: one thread checks every
+// row, one every column, and nine check a 3x3 subgrid each.  The main
+// thread joins them and returns 1 if all eleven found their region
+// valid.  Threads are created for every call, placed on CPUs by
+// thread_launch() (see ../common/thread_launch.h).
+int check_grid_threads(const sudoku_grid_t* grid);
+
+#endif // sudoku_threads_h
@@ -0,0 +1,147 @@
+#include <string.h>
+
+#include "sudoku_tracker.h"
+
+// Units are numbered rows 0-8, columns 9-17, boxes 18-26.
+#define ROW_UNIT(row)      (row)
+#define COL_UNIT(col)      (PUZZLE_SIZE + (col))
+#define BOX_UNIT(row, col) (2 * PUZZLE_SIZE + (row) / 3 * 3 + (col) / 3)
+
+static inline int get_nibble(const uint8_t* a, int i) {
+    return (a[i / 2] >> (i % 2 * 4)) & 0xf;
+}
+
+// Adds delta (+1 or -1) to nibble i; it must stay within 0-15.
+static inline void add_nibble(uint8_t* a, int i, int delta) {
+    a[i / 2] += (uint8_t)(delta * (1 << (i % 2 * 4)));
+}
+
+static inline void set_nibble(uint8_t* a, int i, int value) {
+    int shift = i % 2 * 4;
+    a[i / 2] = (a[i / 2] & ~(0xf << shift)) | (value << shift);
+}
+
+// One more (delta 1) or one less (delta -1) of digit in unit.  A count
+// going 1 -> 2 starts a repeat, 2 -> 1 ends one.
+static inline void count_digit(sudoku_tracker_t* tracker, int unit, int digit, int delta) {
+    int i = unit * PUZZLE_SIZE + digit - 1;
+    int before = get_nibble(tracker->count, i);
+    add_nibble(tracker->count, i, delta);
+    if ((before > 1) == (before + delta > 1)) {
+        return;
+    }
+    tracker->repeats += delta;
+    add_nibble(tracker->dups, unit, delta);
+    uint16_t bit = 1 << (unit % PUZZLE_SIZE);
+    if (get_nibble(tracker->dups, unit) > 0) {
+        tracker->conflicts[unit / PUZZLE_SIZE] |= bit;
+    } else {
+        tracker->conflicts[unit / PUZZLE_SIZE] &= ~bit;
+    }
+}
+
+static inline void count_cell(sudoku_tracker_t* tracker, int row, int col, int digit,
+                              int delta) {
+    count_digit(tracker, ROW_UNIT(row), digit, delta);
+    count_digit(tracker, COL_UNIT(col), digit, delta);
+    count_digit(tracker, BOX_UNIT(row, col), digit, delta);
+    tracker->filled += delta;
+}
+
+int tracker_init(sudoku_tracker_t* tracker, const sudoku_grid_t* grid) {
+    memset(tracker, 0, sizeof(*tracker));
+    if (grid == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        if (grid->cell[i] > PUZZLE_SIZE) {
+            memset(tracker, 0, sizeof(*tracker));
+            return -1;
+        }
+    }
+    for (int row = 0; row < PUZZLE_SIZE; row++) {
+        for (int col = 0; col < PUZZLE_SIZE; col++) {
+            tracker_set(tracker, row, col, GRID_AT(grid, row, col));
+        }
+    }
+    return 0;
+}
+
+int tracker_set(sudoku_tracker_t* tracker, int row, int col, int digit) {
+    if ((unsigned)row >= PUZZLE_SIZE || (unsigned)col >= PUZZLE_SIZE ||
+        (unsigned)digit > PUZZLE_SIZE) {
+        return -1;
+    }
+    int i = row * PUZZLE_SIZE + col;
+    int old = get_nibble(tracker->cell, i);
+    if (old != digit) {
+        if (old != 0) {
+            count_cell(tracker, row, col, old, -1);
+        }
+        if (digit != 0) {
+            count_cell(tracker, row, col, digit, 1);
+        }
+        set_nibble(tracker->cell, i, digit);
+    }
+    return tracker_valid(tracker);
+}
+
+int tracker_get(const sudoku_tracker_t* tracker, int row, int col) {
+    return get_nibble(tracker->cell, row * PUZZLE_SIZE + col);
+}
+
+int tracker_valid(const sudoku_tracker_t* tracker) {
+    return tracker->filled == PUZZLE_CELLS && tracker->repeats == 0;
+}
+
+int tracker_conflict(const sudoku_tracker_t* tracker, int row, int col) {
+    int digit = tracker_get(tracker, row, col);
+    if (digit == 0) {
+        return 0;
+    }
+    return get_nibble(tracker->count, ROW_UNIT(row) * PUZZLE_SIZE + digit - 1) > 1 ||
+           get_nibble(tracker->count, COL_UNIT(col) * PUZZLE_SIZE + digit - 1) > 1 ||
+           get_nibble(tracker->count, BOX_UNIT(row, col) * PUZZLE_SIZE + digit - 1) > 1;
+}
+
+// Flags the cells of unit whose digit is repeated in it.
+static void flag_repeats(const sudoku_tracker_t* tracker, int unit, sudoku_diag_t* diag) {
+    for (int k = 0; k < PUZZLE_SIZE; k++) {
+        int row, col;
+        if (unit < PUZZLE_SIZE) {
+            row = unit, col = k;
+        } else if (unit < 2 * PUZZLE_SIZE) {
+            row = k, col = unit - PUZZLE_SIZE;
+        } else {
+            int box = unit - 2 * PUZZLE_SIZE;
+            row = box / 3 * 3 + k / 3, col = box % 3 * 3 + k % 3;
+        }
+        int i = row * PUZZLE_SIZE + col;
+        int digit = get_nibble(tracker->cell, i);
+        if (digit != 0 && get_nibble(tracker->count, unit * PUZZLE_SIZE + digit - 1) > 1 &&
+            !DIAG_CELL(diag, i)) {
+            diag->cells[i / 8] |= 1 << (i % 8);
+            diag->num_cells++;
+        }
+    }
+}
+
+int tracker_diagnose(const sudoku_tracker_t* tracker, sudoku_diag_t* diag) {
+    memset(diag, 0, sizeof(*diag));
+    diag->rows = tracker->conflicts[0];
+    diag->cols = tracker->conflicts[1];
+    diag->boxes = tracker->conflicts[2];
+    // only the units in conflict can hold a flagged cell
+    for (int kind = 0; kind < 3; kind++) {
+        for (unsigned mask = tracker->conflicts[kind]; mask != 0; mask &= mask - 1) {
+            flag_repeats(tracker, kind * PUZZLE_SIZE + __builtin_ctz(mask), diag);
+        }
+    }
+    return tracker_valid(tracker);
+}
+
+void tracker_grid(const sudoku_tracker_t* tracker, sudoku_grid_t* grid) {
+    for (int i = 0; i < PUZZLE_CELLS; i++) {
+        grid->cell[i] = get_nibble(tracker->cell, i);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef sudoku_tracker_h
+#define sudoku_tracker_h
+
+#include <stdint.h>
+
+#include "sudoku_check.h"
+
+// Incremental validity of a 9x9 grid being edited one cell at a time.
+// The same 27 units as check_row(), check_col() and check_subgrid() are
+// tracked, but instead of rescanning them the tracker keeps how many
+// times each digit occurs in each unit, so setting or clearing a cell
+// touches only the 3 counts of its row, column and box.  A unit is in
+// conflict while some digit occurs in it more than once; the grid is
+// valid once all 81 cells are filled and no unit is in conflict.
+//
+// Cells and counts are packed 4 bits each, so a tracker is under 200
+// bytes and many sessions fit in memory at once.  A tracker has no
+// shared state: different sessions may be edited on different threads
+// without locking (edits to one session must not overlap).
+typedef struct {
+    uint16_t conflicts[3];   // rows, columns, boxes: bit i if unit i has a repeat
+    uint8_t filled;          // cells holding a digit
+    uint8_t repeats;         // (unit, digit) pairs with the digit more than once
+    uint8_t cell[(PUZZLE_CELLS + 1) / 2];              // digit of each cell, 0 empty
+    uint8_t count[(3 * PUZZLE_SIZE * PUZZLE_SIZE + 1) / 2]; // unit * 9 + digit - 1
+    uint8_t dups[(3 * PUZZLE_SIZE + 1) / 2];          // repeated digits of each unit
+} sudoku_tracker_t;
+
+// Starts tracking grid (or an empty grid if NULL).  Returns 0, or -1 if
+// a cell holds something other than 0-9.
+int tracker_init(sudoku_tracker_t* tracker, const sudoku_grid_t* grid);
+
+// Puts digit (0 to clear) in a cell, and returns whether the grid is
+// now valid, or -1 if row, col or digit is out of range.
+int tracker_set(sudoku_tracker_t* tracker, int row, int col, int digit);
+
+// The digit of a cell, 0 if empty.
+int tracker_get(const sudoku_tracker_t* tracker, int row, int col);
+
+// 1 if the grid is full and has no conflicts.
+int tracker_valid(const sudoku_tracker_t* tracker);
+
+// 1 if the cell holds a digit repeated in its row, column or box.
+int tracker_conflict(const sudoku_tracker_t* tracker, int row, int col);
+
+// The conflict set as a sudoku_diag_t: units with a repeated digit and
+// the cells holding one.  Empty cells aren't flagged, so while the grid
+// is being filled only real clashes show; for a full grid this is what
+// sudoku_diagnose() reports.  Returns tracker_valid().
+int tracker_diagnose(const sudoku_tracker_t* tracker, sudoku_diag_t* diag);
+
+// Copies the cells back to grid.
+void tracker_grid(const sudoku_tracker_t* tracker, sudoku_grid_t* grid);
+
+#endif // sudoku_tracker_h
@@ -0,0 +1,144 @@
+#include <sched.h>   // for sched_yield()
+#include "atomic_room.h"
+#include "perturb.h"
+
+#define BYPASS_SHIFT  32
+#define GUARD_SHIFT   48
+#define STUDENT_MASK  0xffffffffull
+#define BYPASS_ONE    (1ull << BYPASS_SHIFT)
+#define BYPASS_MAX    0xffff   // what fits in bits 32..47
+
+#define NUM_STUDENTS(w)  ((int) ((w) & STUDENT_MASK))
+#define NUM_BYPASSED(w)  ((int) (((w) >> BYPASS_SHIFT) & 0xffff))
+#define GUARD_STATE(w)   ((int) ((w) >> GUARD_SHIFT))
+
+// new guard state, with the bypass count starting over at zero
+#define WITH_GUARD(w, g) (((w) & STUDENT_MASK) | ((uint64_t) (g) << GUARD_SHIFT))
+
+void atomic_room_init(atomic_room* r, int capacity,
+                      room_policy_t policy, int bypass_limit)
+{
+  atomic_init(&r->state, WITH_GUARD(0, ROOM_GUARD_HALL));
+  r->capacity     = capacity;
+  r->policy       = policy;
+  // a larger limit would let the bypass count carry into the guard state
+  r->bypass_limit = bypass_limit < 0 ? 0
+                  : bypass_limit > BYPASS_MAX ? BYPASS_MAX : bypass_limit;
+  semInitB(&r->room_empty, 0);
+  pthread_mutex_init(&r->gate_mutex, NULL);
+  pthread_cond_init(&r->gate_cv, NULL);
+}
+
+void atomic_room_destroy(atomic_room* r)
+{
+  pthread_cond_destroy(&r->gate_cv);
+  pthread_mutex_destroy(&r->gate_mutex);
+  semDestroyB(&r->room_empty);
+}
+
+// does the guard keep students out of the room in state w?
+static int guard_blocks(atomic_room* r, uint64_t w)
+{
+  switch (GUARD_STATE(w)) {
+  case ROOM_GUARD_HALL:    return 0;
+  case ROOM_GUARD_IN_ROOM: return 1;
+  default:
+    switch (r->policy) {
+    case ROOM_STUDENT_PRIORITY: return 0;
+    case ROOM_BOUNDED_BYPASS:   return NUM_BYPASSED(w) >= r->bypass_limit;
+    default:                    return 1;
+    }
+  }
+}
+
+// park until the guard lets students in again (slow path for students)
+static void wait_for_guard(atomic_room* r)
+{
+  pthread_mutex_lock(&r->gate_mutex);
+
+  // re-examine the state while holding gate_mutex: the guard takes
+  // gate_mutex after clearing its state, so the wakeup can't be lost
+  while (guard_blocks(r, atomic_load(&r->state)))
+    pthread_cond_wait(&r->gate_cv, &r->gate_mutex);
+
+  pthread_mutex_unlock(&r->gate_mutex);
+}
+
+int atomic_room_student_enter(atomic_room* r)
+{
+  uint64_t w = atomic_load_explicit(&r->state, memory_order_relaxed);
+
+  while (1) {
+    if (guard_blocks(r, w)) {
+      wait_for_guard(r);
+      w = atomic_load_explicit(&r->state, memory_order_relaxed);
+    } else if (NUM_STUDENTS(w) >= r->capacity) {
+      // room is full: step out of the way and try again
+      sched_yield();
+      w = atomic_load_explicit(&r->state, memory_order_relaxed);
+    } else {
+      // count ourselves as bypassing the guard if it is waiting (only
+      // the bounded policy counts, and guard_blocks() stops it at
+      // bypass_limit, which init keeps within 16 bits)
+      uint64_t next = w + 1;
+      if (GUARD_STATE(w) == ROOM_GUARD_WAITING &&
+          r->policy == ROOM_BOUNDED_BYPASS)
+        next += BYPASS_ONE;
+
+      PERTURB();  // between reading the state and the CAS
+      if (atomic_compare_exchange_weak_explicit(&r->state, &w, next,
+                                                memory_order_acquire,
+                                                memory_order_relaxed))
+        return NUM_STUDENTS(w) + 1;
+    }
+    // on a failed CAS, w already holds the current state
+  }
+}
+
+void atomic_room_student_leave(atomic_room* r)
+{
+  uint64_t w = atomic_fetch_sub_explicit(&r->state, 1, memory_order_acq_rel);
+
+  if (NUM_STUDENTS(w) == 1 && GUARD_STATE(w) == ROOM_GUARD_WAITING) {
+    // last student out lets the waiting guard in
+    PERTURB();
+    semSignalB(&r->room_empty);
+  }
+}
+
+int atomic_room_guard_enter(atomic_room* r)
+{
+  uint64_t w = atomic_load(&r->state);
+  int found = NUM_STUDENTS(w);
+
+  while (1) {
+    if (NUM_STUDENTS(w) == 0) {
+      if (atomic_compare_exchange_weak(&r->state, &w,
+                                       WITH_GUARD(w, ROOM_GUARD_IN_ROOM)))
+        return found;
+    } else if (GUARD_STATE(w) != ROOM_GUARD_WAITING) {
+      // announce that we are waiting, then look at the room again
+      uint64_t waiting = WITH_GUARD(w, ROOM_GUARD_WAITING);
+      PERTURB();
+      if (atomic_compare_exchange_weak(&r->state, &w, waiting))
+        w = waiting;
+    } else {
+      // room_empty may be stale (left over from an earlier wait), so
+      // the count is always checked again after waking up
+      semWaitB(&r->room_empty);
+      w = atomic_load(&r->state);
+    }
+  }
+}
+
+void atomic_room_guard_leave(atomic_room* r)
+{
+  // the count can change under us, so only the guard bits are cleared
+  // (the bypass count is already zero while the guard is in the room)
+  atomic_fetch_sub(&r->state, (uint64_t) ROOM_GUARD_IN_ROOM << GUARD_SHIFT);
+  PERTURB();
+
+  pthread_mutex_lock(&r->gate_mutex);
+  pthread_cond_broadcast(&r->gate_cv);
+  pthread_mutex_unlock(&r->gate_mutex);
+}
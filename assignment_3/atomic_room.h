@@ -0,0 +1,46 @@
+#ifndef atomic_room_impl_h
+#define atomic_room_impl_h
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "binary_semaphore.h"
+#include "room_policy.h"
+
+// Room protocol for the security guard problem with num_students and
+// guard_state packed into one atomic word, so a student enters and
+// leaves with a single compare-and-swap (or fetch-and-sub).  Only the
+// guard's transitions, and students that the policy keeps out while
+// the guard waits or is in the room, block.
+//
+// layout of "state":
+//          bits  0..31 : number of students in the room
+//          bits 32..47 : students let in since the guard started waiting
+//          bits 48..49 : guard state (ROOM_GUARD_* below)
+#define ROOM_GUARD_HALL     0   // guard is in the hall of department
+#define ROOM_GUARD_WAITING  1   // guard is waiting to enter the room
+#define ROOM_GUARD_IN_ROOM  2   // guard is IN the room
+
+typedef struct {
+  _Atomic uint64_t state;        // packed student count and guard state
+  int              capacity;     // maximum number of students in the room
+  room_policy_t    policy;       // who goes first while the guard waits
+  int              bypass_limit; // ROOM_BOUNDED_BYPASS: students let in
+                                 //   while waiting (clamped to 0..65535)
+  binary_semaphore room_empty;   // last student out wakes a waiting guard
+  pthread_mutex_t  gate_mutex;   // students kept out by the guard wait
+  pthread_cond_t   gate_cv;      //   on gate_cv until the guard leaves
+} atomic_room;
+
+void atomic_room_init         (atomic_room* r, int capacity,
+                               room_policy_t policy, int bypass_limit);
+void atomic_room_destroy      (atomic_room* r);
+
+// same return values as the sem_room functions of the same name
+int  atomic_room_student_enter(atomic_room* r);
+void atomic_room_student_leave(atomic_room* r);
+int  atomic_room_guard_enter  (atomic_room* r);
+void atomic_room_guard_leave  (atomic_room* r);
+
+#endif // atomic_room_impl_h
@@ -0,0 +1,139 @@
+#include <sched.h>   // for sched_yield()
+#include <stdlib.h>  // for malloc(), free()
+#include "barrier.h"
+#include "perturb.h"
+
+#define SPIN_LIMIT 1000   // spins before each sched_yield()
+
+// wait until the release flag says round local_sense is over
+static void wait_for_release(atomic_int* sense, int local_sense)
+{
+  int spins = 0;
+
+  while (atomic_load_explicit(sense, memory_order_acquire) != local_sense) {
+    if (++spins == SPIN_LIMIT) {
+      sched_yield();   // whoever is still to arrive may need this CPU
+      spins = 0;
+    }
+  }
+}
+
+void sense_barrier_init(sense_barrier* b, int n)
+{
+  atomic_init(&b->count, 0);
+  atomic_init(&b->sense, 0);
+  b->n = n;
+}
+
+void sense_barrier_destroy(sense_barrier* b)
+{
+  (void) b;   // nothing allocated
+}
+
+int sense_barrier_wait(sense_barrier* b, int* local_sense)
+{
+  *local_sense = !*local_sense;
+
+  if (atomic_fetch_add_explicit(&b->count, 1, memory_order_acq_rel) + 1 < b->n) {
+    wait_for_release(&b->sense, *local_sense);
+    return 0;
+  }
+  // last to arrive: nobody touches count again until the release below,
+  // which publishes the reset along with everyone's work of this round
+  atomic_store_explicit(&b->count, 0, memory_order_relaxed);
+  PERTURB();
+  atomic_store_explicit(&b->sense, *local_sense, memory_order_release);
+  return 1;
+}
+
+int tree_barrier_init(tree_barrier* b, int n, int fanin)
+{
+  if (fanin < 2)
+    return -1;
+
+  // the leaves take fanin threads each, every level above fanin nodes
+  int num_nodes = 0;
+  for (int width = n; width > 1 || num_nodes == 0; width = (width + fanin - 1) / fanin)
+    num_nodes += (width + fanin - 1) / fanin;
+
+  b->nodes = aligned_alloc(BARRIER_CACHE_LINE, num_nodes * sizeof(tree_node));
+  if (b->nodes == NULL)
+    return -1;
+
+  // level by level: below is how many threads or nodes arrive at the
+  // level, first is the index of its first node
+  int first = 0, below = n;
+  do {
+    int width = (below + fanin - 1) / fanin;
+    for (int i = 0; i < width; i++) {
+      tree_node* node = &b->nodes[first + i];
+      atomic_init(&node->count, 0);
+      node->expected = (i < width - 1) ? fanin : below - fanin * (width - 1);
+      node->parent   = (width > 1) ? first + width + i / fanin : -1;
+    }
+    first += width;
+    below = width;
+  } while (below > 1);
+
+  b->n     = n;
+  b->fanin = fanin;
+  atomic_init(&b->sense, 0);
+  return 0;
+}
+
+void tree_barrier_destroy(tree_barrier* b)
+{
+  free(b->nodes);
+  b->nodes = NULL;
+}
+
+int tree_barrier_wait(tree_barrier* b, int id, int* local_sense)
+{
+  int node = id / b->fanin;
+
+  *local_sense = !*local_sense;
+  while (1) {
+    tree_node* here = &b->nodes[node];
+
+    if (atomic_fetch_add_explicit(&here->count, 1, memory_order_acq_rel) + 1 < here->expected) {
+      wait_for_release(&b->sense, *local_sense);
+      return 0;
+    }
+    // last at this node: reset it for the next round and carry on up
+    atomic_store_explicit(&here->count, 0, memory_order_relaxed);
+    if (here->parent < 0)
+      break;
+    node = here->parent;
+    PERTURB();
+  }
+  atomic_store_explicit(&b->sense, *local_sense, memory_order_release);
+  return 1;
+}
+
+void countdown_latch_init(countdown_latch* l, int count)
+{
+  atomic_init(&l->count, count);
+  semInitB(&l->opened, count <= 0);
+}
+
+void countdown_latch_destroy(countdown_latch* l)
+{
+  // no thread may be blocked in countdown_latch_wait() when this is called
+  semDestroyB(&l->opened);
+}
+
+void countdown_latch_count_down(countdown_latch* l)
+{
+  if (atomic_fetch_sub_explicit(&l->count, 1, memory_order_acq_rel) == 1)
+    semSignalB(&l->opened);
+}
+
+void countdown_latch_wait(countdown_latch* l)
+{
+  if (atomic_load_explicit(&l->count, memory_order_acquire) <= 0)
+    return;   // already open: no need for the semaphore
+
+  semWaitB(&l->opened);
+  PERTURB();
+  semSignalB(&l->opened);   // cascade: let the next waiter through too
+}
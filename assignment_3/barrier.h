@@ -0,0 +1,70 @@
+#ifndef barrier_impl_h
+#define barrier_impl_h
+
+#include <stdatomic.h>
+
+#include "binary_semaphore.h"
+
+#define BARRIER_CACHE_LINE 64
+
+// Barriers for a fixed group of n threads, reusable round after round.
+// Waiting threads spin for a while and then yield the CPU, so they keep
+// working when there are more threads than CPUs.  Each thread keeps its
+// own sense flag (an int set to 0 before the first wait and not touched
+// otherwise) and passes it to every wait: the flag flips each round, so
+// a round's release can't be mistaken for the next one's.  Both waits
+// return 1 in exactly one thread per round (the last to arrive), 0 in
+// the others, like PTHREAD_BARRIER_SERIAL_THREAD.
+
+// Centralized sense-reversing barrier: one arrival counter, and one flag
+// that the last thread to arrive flips to release the others.  Every
+// arrival hits the same cache line, which is what limits it at high
+// thread counts.
+typedef struct {
+  _Alignas(BARRIER_CACHE_LINE) atomic_int count;  // arrivals this round
+  _Alignas(BARRIER_CACHE_LINE) atomic_int sense;  // flips once per round
+  int n;
+} sense_barrier;
+
+void sense_barrier_init   (sense_barrier* b, int n);
+void sense_barrier_destroy(sense_barrier* b);
+int  sense_barrier_wait   (sense_barrier* b, int* local_sense);
+
+// Combining-tree barrier: threads arrive in groups of fanin at the
+// leaves of a tree, and the last to arrive at a node goes on to its
+// parent, so no counter is shared by more than fanin threads.  The one
+// that completes the root flips the release flag.  Thread ids run from
+// 0 to n - 1; each thread passes its own.
+typedef struct {
+  _Alignas(BARRIER_CACHE_LINE) atomic_int count;  // arrivals this round
+  int expected;                                   // threads or nodes below
+  int parent;                                     // node index; -1 at the root
+} tree_node;
+
+typedef struct {
+  tree_node* nodes;   // the leaves first, then each level up to the root
+  int        n, fanin;
+  _Alignas(BARRIER_CACHE_LINE) atomic_int sense;
+} tree_barrier;
+
+// returns 0, or -1 if the nodes can't be allocated (or fanin < 2)
+int  tree_barrier_init   (tree_barrier* b, int n, int fanin);
+void tree_barrier_destroy(tree_barrier* b);
+int  tree_barrier_wait   (tree_barrier* b, int id, int* local_sense);
+
+// Countdown latch: opens for good once count_down() has been called
+// count times, and wait() blocks until then.  Waiters park on a binary
+// semaphore; each one that wakes signals it again for the next, so one
+// signal lets them all through.  Calls to count_down() past the count
+// are not allowed.
+typedef struct {
+  atomic_int       count;   // count_down() calls still to come
+  binary_semaphore opened;
+} countdown_latch;
+
+void countdown_latch_init      (countdown_latch* l, int count);
+void countdown_latch_destroy   (countdown_latch* l);
+void countdown_latch_count_down(countdown_latch* l);
+void countdown_latch_wait      (countdown_latch* l);
+
+#endif // barrier_impl_h
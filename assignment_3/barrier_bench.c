@@ -0,0 +1,164 @@
+// Round-trip latency of the barriers in barrier.h against
+// pthread_barrier_t, with 2, 4, ... 128 threads: every thread goes
+// through the barrier rounds times, and the latency is the time per
+// round.  Before timing, each barrier is checked on a few rounds: no
+// thread may leave round r before all have arrived at it, and exactly
+// one per round is told it was the last.  The threads are started
+// together by a countdown_latch, which is then checked as well.
+//
+// to compile enter:
+//    cc -Wall -O2 barrier_bench.c barrier.c binary_semaphore.c -lpthread
+// or, for the stress build, with yields at the PERTURB() points (and TSAN):
+//    cc -Wall -O1 -g -fsanitize=thread -DROOM_STRESS -I../common barrier_bench.c barrier.c binary_semaphore.c perturb.c ../common/rng.c -lpthread
+// usage:
+//    ./a.out [rounds] [max_threads] [fanin]
+
+#include <stdio.h>
+#include <stdlib.h>  // for atoi(), malloc()
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>    // for clock_gettime()
+
+#include "barrier.h"
+
+#define MAX_THREADS  128
+#define CHECK_ROUNDS 200
+
+typedef enum { PTHREAD_IMPL, SENSE_IMPL, TREE_IMPL, NUM_IMPLS } impl_kind;
+
+static const char* const impl_names[NUM_IMPLS] = { "pthread", "sense", "tree" };
+
+static impl_kind          kind;        // barrier under test
+static pthread_barrier_t  pbarrier;
+static sense_barrier      sbarrier;
+static tree_barrier       tbarrier;
+static countdown_latch    ready;       // counted down by each thread
+static countdown_latch    go;          // opened by main() once all are ready
+static int                num_threads;
+static int                rounds;
+static int                checking;    // check the rounds instead of timing them
+static atomic_long        arrivals;    // checking: arrivals over all rounds
+static atomic_long        serials;     // checking: waits that returned 1
+static atomic_int         failures;
+
+// one wait; 1 in the thread the barrier picked as the last one
+static int barrier_wait(int id, int* local_sense)
+{
+  switch (kind) {
+  case PTHREAD_IMPL:
+    return pthread_barrier_wait(&pbarrier) == PTHREAD_BARRIER_SERIAL_THREAD;
+  case SENSE_IMPL:
+    return sense_barrier_wait(&sbarrier, local_sense);
+  default:
+    return tree_barrier_wait(&tbarrier, id, local_sense);
+  }
+}
+
+static void* worker(void* arg)
+{
+  int id = (int) (long) arg;
+  int local_sense = 0;
+
+  countdown_latch_count_down(&ready);
+  countdown_latch_wait(&go);
+
+  if (!checking) {
+    for (int r = 0; r < rounds; r++)
+      barrier_wait(id, &local_sense);
+    return NULL;
+  }
+  for (long r = 0; r < CHECK_ROUNDS; r++) {
+    atomic_fetch_add(&arrivals, 1);
+    if (barrier_wait(id, &local_sense))
+      atomic_fetch_add(&serials, 1);
+    // everyone has arrived at round r, and nobody can arrive at r + 1
+    // before this thread does
+    long seen = atomic_load(&arrivals);
+    if (seen < (r + 1) * num_threads || seen > (r + 2) * num_threads - 1)
+      atomic_store(&failures, 1);
+  }
+  return NULL;
+}
+
+// Runs the threads through the barrier; returns the seconds from the
+// latch opening to the last thread done.
+static double run(impl_kind which, int n, int fanin)
+{
+  pthread_t threads[MAX_THREADS];
+  struct timespec t0, t1;
+
+  kind = which;
+  num_threads = n;
+  switch (kind) {
+  case PTHREAD_IMPL: pthread_barrier_init(&pbarrier, NULL, n); break;
+  case SENSE_IMPL:   sense_barrier_init(&sbarrier, n); break;
+  default:
+    if (tree_barrier_init(&tbarrier, n, fanin) != 0) {
+      fprintf(stderr, "fanin must be at least 2\n");
+      exit(1);
+    }
+  }
+  countdown_latch_init(&ready, n);
+  countdown_latch_init(&go, 1);
+
+  for (long i = 0; i < n; i++)
+    pthread_create(&threads[i], NULL, worker, (void*) i);
+  countdown_latch_wait(&ready);
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  countdown_latch_count_down(&go);
+  for (int i = 0; i < n; i++)
+    pthread_join(threads[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  countdown_latch_destroy(&go);
+  countdown_latch_destroy(&ready);
+  switch (kind) {
+  case PTHREAD_IMPL: pthread_barrier_destroy(&pbarrier); break;
+  case SENSE_IMPL:   sense_barrier_destroy(&sbarrier); break;
+  default:           tree_barrier_destroy(&tbarrier);
+  }
+  return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+static void check(impl_kind which, int n, int fanin)
+{
+  checking = 1;
+  atomic_store(&arrivals, 0);
+  atomic_store(&serials, 0);
+  atomic_store(&failures, 0);
+  run(which, n, fanin);
+  checking = 0;
+
+  if (atomic_load(&failures) || atomic_load(&serials) != CHECK_ROUNDS) {
+    printf("%s barrier with %d threads let a thread through early, or picked "
+           "%ld last threads in %d rounds\n", impl_names[which], n,
+           atomic_load(&serials), CHECK_ROUNDS);
+    exit(1);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int total       = argc > 1 ? atoi(argv[1]) : 200000;
+  int max_threads = argc > 2 ? atoi(argv[2]) : MAX_THREADS;
+  int fanin       = argc > 3 ? atoi(argv[3]) : 4;
+
+  if (max_threads < 2 || max_threads > MAX_THREADS) {
+    fprintf(stderr, "max_threads must be between 2 and %d\n", MAX_THREADS);
+    return 1;
+  }
+
+  printf("tree fanin %d; rounds per run: %d / threads (at least 100)\n", fanin, total);
+  printf("Barrier | Threads | Rounds | Round trip (us) | per thread (ns)\n");
+  for (int n = 2; n <= max_threads; n *= 2) {
+    // fewer rounds with more threads, so every run takes about as long
+    rounds = total / n > 100 ? total / n : 100;
+    for (int k = 0; k < NUM_IMPLS; k++) {
+      check((impl_kind) k, n, fanin);
+      double elapsed = run((impl_kind) k, n, fanin);
+      printf("%-7s | %7d | %6d | %15.2f | %15.1f\n", impl_names[k], n, rounds,
+             elapsed * 1e6 / rounds, elapsed * 1e9 / rounds / n);
+    }
+  }
+  return 0;
+}
@@ -1,5 +1,6 @@
 #include <pthread.h>
 #include "binary_semaphore.h"
+#include "perturb.h"
 
 void semInitB(binary_semaphore* s, int state)
 {
@@ -31,6 +32,7 @@ void semWaitB(binary_semaphore* s)
   // -------------------------------------------
   s->flag = 0;  // This will cause all other threads that execute a
                 // semWaitB() call to wait in the (above) while-loop
+  PERTURB();
 
   // release exclusive access to s->flag
   pthread_mutex_unlock(&(s->mutex));  
@@ -48,8 +50,16 @@ void semSignalB(binary_semaphore* s)
   // operation does nothing.
 
   // update semaphore state to Up
+  PERTURB();
   s->flag = 1;
 
   // release exclusive access to s->flag
   pthread_mutex_unlock(&(s->mutex)); 
 }
+
+void semDestroyB(binary_semaphore* s)
+{
+  // no thread may be blocked in semWaitB() when this is called
+  pthread_cond_destroy(&(s->cv));
+  pthread_mutex_destroy(&(s->mutex));
+}
@@ -13,5 +13,6 @@ typedef struct {
 void semInitB  (binary_semaphore* s, int state);
 void semWaitB  (binary_semaphore* s);
 void semSignalB(binary_semaphore* s);
+void semDestroyB(binary_semaphore* s);
 
 #endif // binary_semaphore_impl_h
@@ -0,0 +1,189 @@
+#include <stdint.h>
+#include <stdlib.h>  // for aligned_alloc(), free()
+#include "mpmc_queue.h"
+#include "perturb.h"
+
+int mpmc_queue_init(mpmc_queue* q, size_t capacity)
+{
+  if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+    return -1;
+
+  // whole cache lines, so the cells share none with anything else
+  size_t bytes = capacity * sizeof(mpmc_cell);
+  bytes = (bytes + MPMC_CACHE_LINE - 1) / MPMC_CACHE_LINE * MPMC_CACHE_LINE;
+  q->cells = aligned_alloc(MPMC_CACHE_LINE, bytes);
+  if (q->cells == NULL)
+    return -1;
+
+  for (size_t i = 0; i < capacity; i++) {
+    atomic_init(&q->cells[i].seq, i);   // cell i waits for push ticket i
+    q->cells[i].value = NULL;
+  }
+  q->mask = capacity - 1;
+  atomic_init(&q->enqueue_pos, 0);
+  atomic_init(&q->dequeue_pos, 0);
+  return 0;
+}
+
+void mpmc_queue_destroy(mpmc_queue* q)
+{
+  free(q->cells);
+  q->cells = NULL;
+}
+
+int mpmc_queue_try_push(mpmc_queue* q, void* value)
+{
+  size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+
+  while (1) {
+    mpmc_cell* cell = &q->cells[pos & q->mask];
+    size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+    if (diff == 0) {
+      // the cell is free for this ticket: claim the ticket
+      if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        cell->value = value;
+        PERTURB();  // ticket taken, value not yet published
+        atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+        return 1;
+      }
+      // on a failed CAS, pos already holds the current ticket
+    } else if (diff < 0) {
+      // the cell still holds last lap's value: the queue is full
+      return 0;
+    } else {
+      // another producer took this ticket; catch up
+      pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+int mpmc_queue_try_pop(mpmc_queue* q, void** value)
+{
+  size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+
+  while (1) {
+    mpmc_cell* cell = &q->cells[pos & q->mask];
+    size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+    if (diff == 0) {
+      // the cell holds this ticket's value: claim the ticket
+      if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        *value = cell->value;
+        PERTURB();
+        // free the cell for the push one lap later
+        atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+        return 1;
+      }
+    } else if (diff < 0) {
+      // nothing pushed for this ticket yet: the queue is empty
+      return 0;
+    } else {
+      pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+size_t mpmc_queue_size(mpmc_queue* q)
+{
+  size_t tail = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+
+  // the two loads aren't one snapshot: pops read after pushes can't
+  // make it negative, but a stale tail can make it too big
+  return head > tail ? (head - tail > q->mask + 1 ? q->mask + 1 : head - tail) : 0;
+}
+
+int blocking_queue_init(blocking_queue* q, size_t capacity)
+{
+  if (mpmc_queue_init(&q->queue, capacity) != 0)
+    return -1;
+  atomic_init(&q->pop_waiters, 0);
+  atomic_init(&q->push_waiters, 0);
+  semInitB(&q->not_empty, 0);
+  semInitB(&q->not_full, 0);
+  return 0;
+}
+
+void blocking_queue_destroy(blocking_queue* q)
+{
+  // no thread may be blocked in push or pop when this is called
+  semDestroyB(&q->not_full);
+  semDestroyB(&q->not_empty);
+  mpmc_queue_destroy(&q->queue);
+}
+
+// After a successful operation: wake a waiter of the other side, if any.
+// The fence orders the operation before the look at the count, against
+// the waiter's fence between raising the count and its last try, so at
+// least one of the two sees the other.
+static void wake(atomic_int* waiters, binary_semaphore* s)
+{
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(waiters, memory_order_relaxed) > 0)
+    semSignalB(s);
+}
+
+void blocking_queue_push(blocking_queue* q, void* value)
+{
+  int woken = 0;
+
+  while (1) {
+    if (mpmc_queue_try_push(&q->queue, value)) {
+      wake(&q->pop_waiters, &q->not_empty);
+      // cascade: the signal that woke us may have stood for several pops
+      if (woken && atomic_load(&q->push_waiters) > 0 &&
+          mpmc_queue_size(&q->queue) <= q->queue.mask)
+        semSignalB(&q->not_full);
+      return;
+    }
+
+    atomic_fetch_add(&q->push_waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    PERTURB();  // announced, not yet looked again
+    if (mpmc_queue_try_push(&q->queue, value)) {
+      atomic_fetch_sub(&q->push_waiters, 1);
+      wake(&q->pop_waiters, &q->not_empty);
+      return;
+    }
+    // the signal may be stale (from before we counted ourselves in), so
+    // the queue is always tried again after waking up
+    semWaitB(&q->not_full);
+    atomic_fetch_sub(&q->push_waiters, 1);
+    woken = 1;
+  }
+}
+
+void* blocking_queue_pop(blocking_queue* q)
+{
+  int woken = 0;
+  void* value;
+
+  while (1) {
+    if (mpmc_queue_try_pop(&q->queue, &value)) {
+      wake(&q->push_waiters, &q->not_full);
+      // cascade: the signal that woke us may have stood for several pushes
+      if (woken && atomic_load(&q->pop_waiters) > 0 && mpmc_queue_size(&q->queue) > 0)
+        semSignalB(&q->not_empty);
+      return value;
+    }
+
+    atomic_fetch_add(&q->pop_waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    PERTURB();
+    if (mpmc_queue_try_pop(&q->queue, &value)) {
+      atomic_fetch_sub(&q->pop_waiters, 1);
+      wake(&q->push_waiters, &q->not_full);
+      return value;
+    }
+    semWaitB(&q->not_empty);
+    atomic_fetch_sub(&q->pop_waiters, 1);
+    woken = 1;
+  }
+}
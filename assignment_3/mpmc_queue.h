@@ -0,0 +1,65 @@
+#ifndef mpmc_queue_impl_h
+#define mpmc_queue_impl_h
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "binary_semaphore.h"
+
+#define MPMC_CACHE_LINE 64
+
+// Bounded multi-producer multi-consumer queue of pointers, lock-free
+// (D. Vyukov's ring): every cell carries a sequence number that says
+// whose turn it is.  Cell i is free for the push of ticket t when its
+// sequence is t, and holds the value for the pop of ticket t when it is
+// t + 1; the pop then sets it to t + capacity, the next lap's push
+// ticket.  A producer claims a ticket with a CAS on enqueue_pos only
+// when the cell is ready for it, so a full or empty queue is reported
+// instead of waited on.  The two positions sit on cache lines of their
+// own, away from each other and from the cells.
+typedef struct {
+  _Atomic size_t seq;
+  void*          value;
+} mpmc_cell;
+
+typedef struct {
+  mpmc_cell* cells;
+  size_t     mask;                                          // capacity - 1
+  _Alignas(MPMC_CACHE_LINE) _Atomic size_t enqueue_pos;     // next push ticket
+  _Alignas(MPMC_CACHE_LINE) _Atomic size_t dequeue_pos;     // next pop ticket
+} mpmc_queue;     // (sized up to whole cache lines by the _Alignas)
+
+// capacity must be a power of 2, at least 2; returns 0, or -1 if it
+// isn't or the cells can't be allocated
+int    mpmc_queue_init    (mpmc_queue* q, size_t capacity);
+void   mpmc_queue_destroy (mpmc_queue* q);
+
+// return 1, or 0 (and do nothing) if the queue is full / empty
+int    mpmc_queue_try_push(mpmc_queue* q, void* value);
+int    mpmc_queue_try_pop (mpmc_queue* q, void** value);
+
+// values in the queue; only a hint while other threads use it
+size_t mpmc_queue_size    (mpmc_queue* q);
+
+// Blocking wrapper: push and pop go straight to the lock-free queue and
+// only park on a binary_semaphore when it is full (push) or empty
+// (pop).  A waiter announces itself in a waiter count before looking at
+// the queue one last time, and the other side signals after its
+// operation only if that count is non-zero, so the fast path touches
+// no lock.  A binary semaphore remembers one signal, not how many, so a
+// woken waiter that finds more waiters and more work passes the signal
+// on (a cascade) instead of leaving them asleep.
+typedef struct {
+  mpmc_queue       queue;
+  _Alignas(MPMC_CACHE_LINE) atomic_int pop_waiters;   // parked on not_empty
+  _Alignas(MPMC_CACHE_LINE) atomic_int push_waiters;  // parked on not_full
+  binary_semaphore not_empty;
+  binary_semaphore not_full;
+} blocking_queue;
+
+int   blocking_queue_init   (blocking_queue* q, size_t capacity);
+void  blocking_queue_destroy(blocking_queue* q);
+void  blocking_queue_push   (blocking_queue* q, void* value);
+void* blocking_queue_pop    (blocking_queue* q);
+
+#endif // mpmc_queue_impl_h
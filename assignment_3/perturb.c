@@ -0,0 +1,30 @@
+#include <sched.h>   // for sched_yield()
+#include <stdint.h>
+#include "perturb.h"
+#include "rng.h"
+
+// Each thread has its own generator, so the choices don't add
+// contention of their own.  A thread that never calls perturb_seed()
+// is seeded from the address of its generator, which differs per
+// thread.
+static _Thread_local rng_t rng;
+static _Thread_local int   seeded;
+
+void perturb_seed(uint64_t seed)
+{
+  rng_seed(&rng, seed);
+  seeded = 1;
+}
+
+void perturb(void)
+{
+  if (!seeded)
+    perturb_seed((uintptr_t) &rng);
+
+  unsigned r = rng_next(&rng) & 63;
+  if (r == 0)
+    sched_yield();
+  else if (r < 8)
+    for (volatile unsigned i = 0; i < r * 16; i++)
+      ;
+}
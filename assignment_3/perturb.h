@@ -0,0 +1,22 @@
+#ifndef perturb_impl_h
+#define perturb_impl_h
+
+#include <stdint.h>
+
+// Perturbation points for stress testing.  Compiled with -DROOM_STRESS,
+// PERTURB() calls perturb() (in perturb.c, which the stress build links
+// in, with ../common/rng.c), which randomly yields or spins, widening
+// the race windows of the code under test.  PERTURB_SEED() seeds the
+// calling thread's choices, so a failing run can be replayed with them.
+// In a normal build both are empty.
+#ifdef ROOM_STRESS
+void perturb(void);
+void perturb_seed(uint64_t seed);
+#define PERTURB()          perturb()
+#define PERTURB_SEED(seed) perturb_seed(seed)
+#else
+#define PERTURB()          ((void) 0)
+#define PERTURB_SEED(seed) ((void) 0)
+#endif
+
+#endif // perturb_impl_h
@@ -0,0 +1,285 @@
+// Producer/consumer benchmark of the bounded queues in mpmc_queue.h
+// with 1, 2, 4, ... 64 threads, half of them producers and half
+// consumers (a single thread pushes and pops by turns):
+//    lock-free  mpmc_queue, yielding the CPU when it is full or empty
+//    blocking   blocking_queue, parking on its semaphores instead
+//    mutex      a ring under one mutex with two condition variables,
+//               for reference
+// Each producer pushes its id and a counter; consumers check that no
+// value is lost or duplicated, and that each producer's values arrive
+// in order.  The table gives values moved through the queue per second
+// (each one push and one pop).
+//
+// to compile enter:
+//    cc -Wall -O2 queue_bench.c mpmc_queue.c binary_semaphore.c -lpthread
+// or, for the stress build, with yields at the PERTURB() points (and TSAN):
+//    cc -Wall -O1 -g -fsanitize=thread -DROOM_STRESS -I../common queue_bench.c mpmc_queue.c binary_semaphore.c perturb.c ../common/rng.c -lpthread
+// usage:
+//    ./a.out [seconds_per_run] [capacity] [max_threads]
+
+#include <stdio.h>
+#include <stdlib.h>  // for atoi(), malloc(), calloc()
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>   // for sched_yield()
+#include <stdatomic.h>
+#include <time.h>    // for clock_gettime(), nanosleep()
+
+#include "mpmc_queue.h"
+
+#define MAX_THREADS 64
+#define ID_SHIFT    40   // value = (producer id + 1) << ID_SHIFT | counter
+
+// the reference queue: a plain ring under a mutex
+typedef struct {
+  void**          values;
+  size_t          capacity, head, count;
+  pthread_mutex_t mutex;
+  pthread_cond_t  not_empty, not_full;
+} mutex_queue;
+
+static void* mutex_create(size_t capacity)
+{
+  mutex_queue* q = malloc(sizeof(mutex_queue));
+  q->values   = malloc(capacity * sizeof(void*));
+  q->capacity = capacity;
+  q->head     = q->count = 0;
+  pthread_mutex_init(&q->mutex, NULL);
+  pthread_cond_init(&q->not_empty, NULL);
+  pthread_cond_init(&q->not_full, NULL);
+  return q;
+}
+
+static void mutex_destroy(void* p)
+{
+  mutex_queue* q = p;
+  pthread_cond_destroy(&q->not_full);
+  pthread_cond_destroy(&q->not_empty);
+  pthread_mutex_destroy(&q->mutex);
+  free(q->values);
+  free(q);
+}
+
+static void mutex_push(void* p, void* value)
+{
+  mutex_queue* q = p;
+  pthread_mutex_lock(&q->mutex);
+  while (q->count == q->capacity)
+    pthread_cond_wait(&q->not_full, &q->mutex);
+  q->values[(q->head + q->count++) % q->capacity] = value;
+  pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->mutex);
+}
+
+static void* mutex_pop(void* p)
+{
+  mutex_queue* q = p;
+  pthread_mutex_lock(&q->mutex);
+  while (q->count == 0)
+    pthread_cond_wait(&q->not_empty, &q->mutex);
+  void* value = q->values[q->head];
+  q->head = (q->head + 1) % q->capacity;
+  q->count--;
+  pthread_cond_signal(&q->not_full);
+  pthread_mutex_unlock(&q->mutex);
+  return value;
+}
+
+static void* lockfree_create(size_t capacity)
+{
+  mpmc_queue* q = aligned_alloc(MPMC_CACHE_LINE, sizeof(mpmc_queue));
+  if (mpmc_queue_init(q, capacity) != 0) {
+    fprintf(stderr, "capacity must be a power of 2\n");
+    exit(1);
+  }
+  return q;
+}
+static void lockfree_destroy(void* q) { mpmc_queue_destroy(q); free(q); }
+
+static void lockfree_push(void* q, void* value)
+{
+  while (!mpmc_queue_try_push(q, value))
+    sched_yield();
+}
+
+static void* lockfree_pop(void* q)
+{
+  void* value;
+  while (!mpmc_queue_try_pop(q, &value))
+    sched_yield();
+  return value;
+}
+
+static void* blocking_create(size_t capacity)
+{
+  blocking_queue* q = aligned_alloc(MPMC_CACHE_LINE, sizeof(blocking_queue));
+  if (blocking_queue_init(q, capacity) != 0) {
+    fprintf(stderr, "capacity must be a power of 2\n");
+    exit(1);
+  }
+  return q;
+}
+static void  blocking_destroy(void* q)          { blocking_queue_destroy(q); free(q); }
+static void  blocking_push(void* q, void* value) { blocking_queue_push(q, value); }
+static void* blocking_pop(void* q)               { return blocking_queue_pop(q); }
+
+// the three queues behind one set of function pointers
+typedef struct {
+  const char* name;
+  void* (*create) (size_t capacity);
+  void  (*destroy)(void* queue);
+  void  (*push)   (void* queue, void* value);
+  void* (*pop)    (void* queue);
+} queue_impl;
+
+static const queue_impl impls[] = {
+  { "lock-free", lockfree_create, lockfree_destroy, lockfree_push, lockfree_pop },
+  { "blocking",  blocking_create, blocking_destroy, blocking_push, blocking_pop },
+  { "mutex",     mutex_create,    mutex_destroy,    mutex_push,    mutex_pop },
+};
+
+// per-thread results, padded so counters don't share cache lines
+typedef struct {
+  _Alignas(64) long pushed;
+  long popped;
+  long errors;                 // values out of order, or not pushed at all
+  long last[MAX_THREADS];      // consumer: last counter seen per producer
+} thread_result;
+
+static const queue_impl* impl;       // implementation under test
+static void*             queue;      // the queue under test
+static atomic_int        stop;       // set by main() when time is up
+static thread_result*    results;
+static int               producers;
+
+// one value of a producer's run; never NULL, which tells consumers to quit
+#define VALUE(id, n) ((void*) (((uintptr_t) (id) + 1) << ID_SHIFT | (uintptr_t) (n)))
+
+static void check(thread_result* r, void* value)
+{
+  uintptr_t v  = (uintptr_t) value;
+  long      id = (long) (v >> ID_SHIFT) - 1;
+  long      n  = (long) (v & ((1ull << ID_SHIFT) - 1));
+
+  if (id < 0 || id >= producers || n <= r->last[id])
+    r->errors++;
+  else
+    r->last[id] = n;
+  r->popped++;
+}
+
+static void* producer(void* arg)
+{
+  long id = (long) arg;
+  long n = 0;
+
+  while (!atomic_load_explicit(&stop, memory_order_relaxed))
+    impl->push(queue, VALUE(id, ++n));
+  results[id].pushed = n;
+  return NULL;
+}
+
+static void* consumer(void* arg)
+{
+  thread_result* r = &results[(long) arg];
+  void* value;
+
+  while ((value = impl->pop(queue)) != NULL)
+    check(r, value);
+  return NULL;
+}
+
+// one thread doing both, a push then a pop
+static void* alone(void* arg)
+{
+  thread_result* r = &results[0];
+  long n = 0;
+
+  while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+    impl->push(queue, VALUE(0, ++n));
+    check(r, impl->pop(queue));
+  }
+  r->pushed = n;
+  return NULL;
+}
+
+static void run(const queue_impl* which, int threads, size_t capacity, int seconds)
+{
+  pthread_t threads_id[MAX_THREADS];
+  struct timespec req = { seconds, 0 };
+  int consumers = threads - threads / 2;
+  long pushed = 0, popped = 0, errors = 0;
+
+  impl      = which;
+  queue     = impl->create(capacity);
+  producers = threads > 1 ? threads / 2 : 1;
+  results   = aligned_alloc(64, threads * sizeof(thread_result));
+  for (int i = 0; i < threads; i++) {
+    results[i].pushed = results[i].popped = results[i].errors = 0;
+    for (int k = 0; k < MAX_THREADS; k++)
+      results[i].last[k] = 0;
+  }
+  atomic_store(&stop, 0);
+
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  if (threads == 1) {
+    pthread_create(&threads_id[0], NULL, alone, NULL);
+  } else {
+    // results: producers first, then the consumers
+    for (long i = 0; i < producers; i++)
+      pthread_create(&threads_id[i], NULL, producer, (void*) i);
+    for (long i = producers; i < threads; i++)
+      pthread_create(&threads_id[i], NULL, consumer, (void*) i);
+  }
+
+  nanosleep(&req, NULL);
+  atomic_store(&stop, 1);
+
+  // producers finish their last push (consumers are still popping),
+  // then every consumer gets a NULL to quit on
+  for (int i = 0; i < (threads == 1 ? 1 : producers); i++)
+    pthread_join(threads_id[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  for (int i = 0; threads > 1 && i < consumers; i++)
+    impl->push(queue, NULL);
+  for (int i = producers; threads > 1 && i < threads; i++)
+    pthread_join(threads_id[i], NULL);
+  double elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+  for (int i = 0; i < threads; i++) {
+    pushed += results[i].pushed;
+    popped += results[i].popped;
+    errors += results[i].errors;
+  }
+  if (pushed != popped || errors != 0) {
+    printf("%s lost or mixed up values: %ld pushed, %ld popped, %ld out of order\n",
+           impl->name, pushed, popped, errors);
+    exit(1);
+  }
+  printf("%-10s | %7d | %9d | %9d | %14.0f\n", impl->name, threads,
+         threads == 1 ? 1 : producers, threads == 1 ? 1 : consumers, popped / elapsed);
+
+  impl->destroy(queue);
+  free(results);
+}
+
+int main(int argc, char** argv)
+{
+  int    seconds     = argc > 1 ? atoi(argv[1]) : 1;
+  size_t capacity    = argc > 2 ? (size_t) atoi(argv[2]) : 1024;
+  int    max_threads = argc > 3 ? atoi(argv[3]) : MAX_THREADS;
+
+  if (max_threads < 1 || max_threads > MAX_THREADS) {
+    fprintf(stderr, "max_threads must be between 1 and %d\n", MAX_THREADS);
+    return 1;
+  }
+
+  printf("capacity %zu, %d s per run\n", capacity, seconds);
+  printf("Queue      | Threads | Producers | Consumers | Values/sec\n");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    for (int k = 0; k < (int) (sizeof(impls) / sizeof(impls[0])); k++)
+      run(&impls[k], threads, capacity, seconds);
+  }
+  return 0;
+}
@@ -0,0 +1,209 @@
+// Throughput benchmark of the two room implementations (sem_room and
+// atomic_room) with a guard and 8, 64 and 512 students, under each
+// admission policy.  Nobody sleeps: students spin briefly inside and
+// outside of the room, so the numbers are dominated by the cost of
+// entering and leaving.  Student throughput (entries/sec) is traded
+// against the guard's latency (average, standard deviation and worst
+// case of its wait to get in).
+//
+// to compile enter:
+//    cc -Wall -O2 -I../common room_bench.c sem_room.c atomic_room.c room_policy.c binary_semaphore.c ../common/thread_launch.c -lpthread -lm
+// threads are placed as THREAD_PLACEMENT says (see thread_launch.h),
+// the guard as thread 0 and the students after it; comparing the wait's
+// standard deviation across placements shows what migrating costs it
+// usage:
+//    ./a.out [seconds_per_run] [capacity] [bypass_limit] [policy]
+
+#include <stdio.h>
+#include <stdlib.h>  // for atoi(), malloc()
+#include <math.h>    // for sqrt()
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>    // for clock_gettime(), nanosleep()
+
+#include "sem_room.h"
+#include "atomic_room.h"
+#include "thread_launch.h"
+
+#define STUDY_SPINS     200  // busy work done inside the room
+#define ELSEWHERE_SPINS 400  // busy work done outside of the room
+#define GUARD_SPINS     200  // busy work done by the guard in the room
+
+// the two implementations behind one set of function pointers
+typedef struct {
+  const char* name;
+  void* (*create)       (int capacity, room_policy_t policy, int bypass_limit);
+  void  (*destroy)      (void* room);
+  int   (*student_enter)(void* room);
+  void  (*student_leave)(void* room);
+  int   (*guard_enter)  (void* room);
+  void  (*guard_leave)  (void* room);
+} room_impl;
+
+static void* sem_create(int capacity, room_policy_t policy, int bypass_limit)
+{
+  sem_room* r = malloc(sizeof(sem_room));
+  sem_room_init(r, capacity, policy, bypass_limit);
+  return r;
+}
+static void sem_destroy(void* r)       { sem_room_destroy(r); free(r); }
+static int  sem_student_enter(void* r) { return sem_room_student_enter(r); }
+static void sem_student_leave(void* r) { sem_room_student_leave(r); }
+static int  sem_guard_enter(void* r)   { return sem_room_guard_enter(r); }
+static void sem_guard_leave(void* r)   { sem_room_guard_leave(r); }
+
+static void* atomic_create(int capacity, room_policy_t policy, int bypass_limit)
+{
+  atomic_room* r = malloc(sizeof(atomic_room));
+  atomic_room_init(r, capacity, policy, bypass_limit);
+  return r;
+}
+static void atomic_destroy(void* r)       { atomic_room_destroy(r); free(r); }
+static int  atomic_student_enter(void* r) { return atomic_room_student_enter(r); }
+static void atomic_student_leave(void* r) { atomic_room_student_leave(r); }
+static int  atomic_guard_enter(void* r)   { return atomic_room_guard_enter(r); }
+static void atomic_guard_leave(void* r)   { atomic_room_guard_leave(r); }
+
+static const room_impl impls[] = {
+  { "semaphore", sem_create, sem_destroy, sem_student_enter,
+    sem_student_leave, sem_guard_enter, sem_guard_leave },
+  { "atomic", atomic_create, atomic_destroy, atomic_student_enter,
+    atomic_student_leave, atomic_guard_enter, atomic_guard_leave },
+};
+
+// per-thread results, padded so counters don't share cache lines
+typedef struct {
+  _Alignas(64) long entries;
+} student_result;
+
+typedef struct {
+  long   checks;        // number of times the guard got into the room
+  double max_wait_us;   // longest time guard_enter() took
+  double total_wait_us; // summed time guard_enter() took
+  double total_sq_us;   // summed squares, for the standard deviation
+} guard_result;
+
+static const room_impl* impl;       // implementation under test
+static void*            room;       // the room under test
+static atomic_int       stop;       // set by main() when time is up
+static student_result*  sresults;
+static guard_result     gresult;
+
+static double now_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void spin(int n)
+{
+  for (volatile int i = 0; i < n; i++)
+    ;
+}
+
+static void* student(void* arg)
+{
+  long id = (long) arg;
+  long entries = 0;
+
+  while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+    impl->student_enter(room);
+    spin(STUDY_SPINS);
+    impl->student_leave(room);
+    spin(ELSEWHERE_SPINS);
+    entries++;
+  }
+  sresults[id].entries = entries;
+  return NULL;
+}
+
+static void* guard(void* arg)
+{
+  guard_result g = { 0, 0.0, 0.0, 0.0 };
+
+  while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+    double start = now_us();
+    impl->guard_enter(room);
+    double waited = now_us() - start;
+    spin(GUARD_SPINS);
+    impl->guard_leave(room);
+
+    g.checks++;
+    g.total_wait_us += waited;
+    g.total_sq_us += waited * waited;
+    if (waited > g.max_wait_us)
+      g.max_wait_us = waited;
+    spin(ELSEWHERE_SPINS);
+  }
+  gresult = g;
+  return NULL;
+}
+
+static void run(const room_impl* which, room_policy_t policy, int n,
+                int capacity, int bypass_limit, int seconds)
+{
+  pthread_t  gthread;
+  pthread_t* sthreads = malloc(n * sizeof(pthread_t));
+  struct timespec req = { seconds, 0 };
+  long i, entries = 0;
+
+  impl     = which;
+  room     = impl->create(capacity, policy, bypass_limit);
+  sresults = aligned_alloc(64, n * sizeof(student_result));
+  atomic_store(&stop, 0);
+
+  double start = now_us();
+  thread_launch(&gthread, 0, guard, NULL);
+  for (i = 0; i < n; i++)
+    thread_launch(&sthreads[i], (int) i + 1, student, (void*) i);
+
+  nanosleep(&req, NULL);
+  atomic_store(&stop, 1);
+
+  pthread_join(gthread, NULL);
+  for (i = 0; i < n; i++) {
+    pthread_join(sthreads[i], NULL);
+    entries += sresults[i].entries;
+  }
+  double elapsed = (now_us() - start) / 1e6;
+  double avg = gresult.checks ? gresult.total_wait_us / gresult.checks : 0.0;
+  double var = gresult.checks ? gresult.total_sq_us / gresult.checks - avg * avg : 0.0;
+
+  printf("%-10s | %-7s | %8d | %14.0f | %12.0f | %14.1f | %14.1f | %14.1f\n",
+         impl->name, room_policy_name(policy), n,
+         entries / elapsed, gresult.checks / elapsed, avg,
+         var > 0 ? sqrt(var) : 0.0, gresult.max_wait_us);
+
+  impl->destroy(room);
+  free(sresults);
+  free(sthreads);
+}
+
+int main(int argc, char** argv)
+{
+  static const int students[] = { 8, 64, 512 };
+  int seconds  = argc > 1 ? atoi(argv[1]) : 1;
+  int capacity = argc > 2 ? atoi(argv[2]) : 1 << 30;  // default: no limit
+  int bypass   = argc > 3 ? atoi(argv[3]) : 16;
+  int only     = argc > 4 ? room_policy_parse(argv[4]) : -1;
+
+  if (argc > 4 && only < 0) {
+    fprintf(stderr, "policy must be one of: student, guard, bypass\n");
+    return 1;
+  }
+
+  printf("thread placement: %s\n", thread_launch_policy());
+  printf("Room       | Policy  | Students | Entries/sec    | Checks/sec   "
+         "| Avg wait (us)  | Wait sd (us)   | Max wait (us)\n");
+  for (int s = 0; s < (int) (sizeof(students) / sizeof(students[0])); s++) {
+    for (int p = 0; p < ROOM_NUM_POLICIES; p++) {
+      if (only >= 0 && p != only)
+        continue;
+      for (int k = 0; k < (int) (sizeof(impls) / sizeof(impls[0])); k++) {
+        run(&impls[k], (room_policy_t) p, students[s], capacity, bypass, seconds);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,18 @@
+#include <string.h>  // for strcmp()
+#include "room_policy.h"
+
+static const char* names[ROOM_NUM_POLICIES] = { "student", "guard", "bypass" };
+
+const char* room_policy_name(room_policy_t policy)
+{
+  return names[policy];
+}
+
+int room_policy_parse(const char* name)
+{
+  for (int i = 0; i < ROOM_NUM_POLICIES; i++) {
+    if (strcmp(name, names[i]) == 0)
+      return i;
+  }
+  return -1;
+}
@@ -0,0 +1,21 @@
+#ifndef room_policy_impl_h
+#define room_policy_impl_h
+
+// Admission policy of a room while the guard is waiting to enter:
+//   ROOM_STUDENT_PRIORITY : students keep entering, the guard waits until
+//                           the room happens to empty (it may starve)
+//   ROOM_GUARD_PRIORITY   : no student enters once the guard is waiting
+//   ROOM_BOUNDED_BYPASS   : at most bypass_limit students enter after the
+//                           guard started waiting, then the guard has priority
+typedef enum room_policies {
+  ROOM_STUDENT_PRIORITY, ROOM_GUARD_PRIORITY, ROOM_BOUNDED_BYPASS
+} room_policy_t;
+
+#define ROOM_NUM_POLICIES  3
+
+// "student", "guard" or "bypass"; room_policy_parse() returns -1 for
+// any other name
+const char* room_policy_name (room_policy_t policy);
+int         room_policy_parse(const char* name);
+
+#endif // room_policy_impl_h
@@ -0,0 +1,292 @@
+// Stress harness for binary_semaphore and both room implementations.
+// Many threads run randomized operations while shadow counters, kept
+// with sequentially consistent atomics, check that
+//    * at most one thread is ever inside a binary_semaphore lock, and
+//      no semWaitB()/semSignalB() handoff is lost
+//    * the guard and students are never in the room together
+//    * there are never more than capacity students in the room
+// The first violated invariant is reported and the program aborts.
+// Built with -DROOM_STRESS, every PERTURB() point in the code under
+// test randomly yields or spins, to shake out different interleavings.
+//
+// to compile enter (plain, then under the thread and address sanitizers):
+//    cc -Wall -O2 -DROOM_STRESS -I../common room_stress.c sem_room.c atomic_room.c room_policy.c binary_semaphore.c perturb.c ../common/rng.c -lpthread
+//    cc -Wall -O1 -g -fsanitize=thread -DROOM_STRESS -I../common room_stress.c sem_room.c atomic_room.c room_policy.c binary_semaphore.c perturb.c ../common/rng.c -lpthread
+//    cc -Wall -O1 -g -fsanitize=address,undefined -DROOM_STRESS -I../common room_stress.c sem_room.c atomic_room.c room_policy.c binary_semaphore.c perturb.c ../common/rng.c -lpthread
+// usage:
+//    ./a.out [ops_per_thread] [num_students] [capacity]
+
+#include <stdio.h>
+#include <stdlib.h>  // for atoi(), abort(), malloc()
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>    // for clock_gettime()
+
+#include "binary_semaphore.h"
+#include "sem_room.h"
+#include "atomic_room.h"
+#include "perturb.h"
+#include "rng.h"
+
+#define START_SEED     11   // arbitrary value to seed random number generator
+
+#define CHECK(cond, ...)                                            \
+  do {                                                              \
+    if (!(cond)) {                                                  \
+      fprintf(stderr, "INVARIANT VIOLATED (%s:%d): ", __FILE__, __LINE__); \
+      fprintf(stderr, __VA_ARGS__);                                 \
+      fprintf(stderr, "\n");                                        \
+      abort();                                                      \
+    }                                                               \
+  } while (0)
+
+// per-thread generator drives the workload and seeds perturb(); thread
+// k uses stream k of START_SEED, so a failing run can be replayed with
+// the same random choices (the interleaving still differs)
+static _Thread_local rng_t rng;
+
+static uint64_t next_rand()
+{
+  return rng_next(&rng);
+}
+
+static void seed_thread(long id)
+{
+  rng_seed(&rng, START_SEED);
+  for (long k = 0; k <= id; k++)
+    rng_jump(&rng);
+  PERTURB_SEED(rng_next(&rng));
+}
+
+static double now_sec()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ------------------------------------------------------------------
+// binary_semaphore: mutual exclusion and ping-pong handoff
+// ------------------------------------------------------------------
+
+static binary_semaphore lock;
+static atomic_int       in_lock;    // threads inside the lock (must be <= 1)
+static long             counter;    // plain counter protected by "lock"
+static binary_semaphore ping, pong;
+static long             ops_per_thread;
+
+static void* lock_worker(void* arg)
+{
+  seed_thread((long) arg);
+  for (long i = 0; i < ops_per_thread; i++) {
+    semWaitB(&lock);
+    int inside = atomic_fetch_add(&in_lock, 1);
+    CHECK(inside == 0, "%d other thread(s) inside binary_semaphore lock", inside);
+    counter++;
+    if ((next_rand() & 15) == 0)
+      PERTURB();
+    atomic_fetch_sub(&in_lock, 1);
+    semSignalB(&lock);
+  }
+  return NULL;
+}
+
+static void* ponger(void* arg)
+{
+  seed_thread(-1);
+  for (long i = 0; i < ops_per_thread; i++) {
+    semWaitB(&ping);
+    semSignalB(&pong);
+  }
+  return NULL;
+}
+
+static void stress_semaphore(int nthreads)
+{
+  pthread_t* threads = malloc(nthreads * sizeof(pthread_t));
+  pthread_t  other;
+  long i;
+
+  semInitB(&lock, 1);
+  counter = 0;
+  double start = now_sec();
+  for (i = 0; i < nthreads; i++)
+    pthread_create(&threads[i], NULL, lock_worker, (void*) i);
+  for (i = 0; i < nthreads; i++)
+    pthread_join(threads[i], NULL);
+  double elapsed = now_sec() - start;
+  CHECK(counter == nthreads * ops_per_thread,
+        "counter is %ld, expected %ld (lost update)",
+        counter, nthreads * ops_per_thread);
+  printf("%-10s | %-7s | %8d | %12ld | %14.0f\n", "semaphore", "lock",
+         nthreads, counter, counter / elapsed);
+  semDestroyB(&lock);
+
+  // every signal must be seen by exactly one wait, or the two threads
+  // below deadlock (and the harness hangs instead of finishing)
+  semInitB(&ping, 0);
+  semInitB(&pong, 0);
+  start = now_sec();
+  pthread_create(&other, NULL, ponger, NULL);
+  for (i = 0; i < ops_per_thread; i++) {
+    semSignalB(&ping);
+    semWaitB(&pong);
+  }
+  pthread_join(other, NULL);
+  elapsed = now_sec() - start;
+  printf("%-10s | %-7s | %8d | %12ld | %14.0f\n", "semaphore", "handoff",
+         2, ops_per_thread, ops_per_thread / elapsed);
+  semDestroyB(&pong);
+  semDestroyB(&ping);
+  free(threads);
+}
+
+// ------------------------------------------------------------------
+// room protocol: guard vs students, and capacity
+// ------------------------------------------------------------------
+
+typedef struct {
+  const char* name;
+  void* (*create)       (int capacity, room_policy_t policy, int bypass_limit);
+  void  (*destroy)      (void* room);
+  int   (*student_enter)(void* room);
+  void  (*student_leave)(void* room);
+  int   (*guard_enter)  (void* room);
+  void  (*guard_leave)  (void* room);
+} room_impl;
+
+static void* sem_create(int capacity, room_policy_t policy, int bypass_limit)
+{
+  sem_room* r = malloc(sizeof(sem_room));
+  sem_room_init(r, capacity, policy, bypass_limit);
+  return r;
+}
+static void sem_destroy(void* r)       { sem_room_destroy(r); free(r); }
+static int  sem_student_enter(void* r) { return sem_room_student_enter(r); }
+static void sem_student_leave(void* r) { sem_room_student_leave(r); }
+static int  sem_guard_enter(void* r)   { return sem_room_guard_enter(r); }
+static void sem_guard_leave(void* r)   { sem_room_guard_leave(r); }
+
+static void* atomic_create(int capacity, room_policy_t policy, int bypass_limit)
+{
+  atomic_room* r = malloc(sizeof(atomic_room));
+  atomic_room_init(r, capacity, policy, bypass_limit);
+  return r;
+}
+static void atomic_destroy(void* r)       { atomic_room_destroy(r); free(r); }
+static int  atomic_student_enter(void* r) { return atomic_room_student_enter(r); }
+static void atomic_student_leave(void* r) { atomic_room_student_leave(r); }
+static int  atomic_guard_enter(void* r)   { return atomic_room_guard_enter(r); }
+static void atomic_guard_leave(void* r)   { atomic_room_guard_leave(r); }
+
+static const room_impl impls[] = {
+  { "semaphore", sem_create, sem_destroy, sem_student_enter,
+    sem_student_leave, sem_guard_enter, sem_guard_leave },
+  { "atomic", atomic_create, atomic_destroy, atomic_student_enter,
+    atomic_student_leave, atomic_guard_enter, atomic_guard_leave },
+};
+
+static const room_impl* impl;         // implementation under test
+static void*            room;         // the room under test
+static int              capacity;
+static atomic_int       students_in;  // shadow count of students in the room
+static atomic_int       guard_in;     // shadow guard state (1 = in the room)
+static atomic_int       students_done;
+static int              num_students;
+
+static void* stress_student(void* arg)
+{
+  seed_thread((long) arg);
+  for (long i = 0; i < ops_per_thread; i++) {
+    int n = impl->student_enter(room);
+    CHECK(n >= 1 && n <= capacity, "student_enter() returned %d", n);
+
+    int inside = atomic_fetch_add(&students_in, 1) + 1;
+    CHECK(inside <= capacity, "%d students in a room of capacity %d",
+          inside, capacity);
+    CHECK(atomic_load(&guard_in) == 0, "student entered with the guard inside");
+    if (next_rand() & 1)
+      PERTURB();
+    atomic_fetch_sub(&students_in, 1);
+
+    impl->student_leave(room);
+    if (next_rand() & 1)
+      PERTURB();
+  }
+  atomic_fetch_add(&students_done, 1);
+  return NULL;
+}
+
+static void* stress_guard(void* arg)
+{
+  long checks = 0;
+
+  seed_thread(0);
+  while (atomic_load(&students_done) < num_students) {
+    impl->guard_enter(room);
+
+    atomic_store(&guard_in, 1);
+    int inside = atomic_load(&students_in);
+    CHECK(inside == 0, "guard entered with %d students inside", inside);
+    PERTURB();
+    atomic_store(&guard_in, 0);
+
+    impl->guard_leave(room);
+    checks++;
+    PERTURB();
+  }
+  return (void*) checks;
+}
+
+static void stress_room(const room_impl* which, room_policy_t policy)
+{
+  pthread_t  gthread;
+  pthread_t* sthreads = malloc(num_students * sizeof(pthread_t));
+  void*      checks;
+  long i;
+
+  impl = which;
+  room = impl->create(capacity, policy, capacity / 2 + 1);
+  atomic_store(&students_in, 0);
+  atomic_store(&guard_in, 0);
+  atomic_store(&students_done, 0);
+
+  double start = now_sec();
+  pthread_create(&gthread, NULL, stress_guard, NULL);
+  for (i = 1; i <= num_students; i++)
+    pthread_create(&sthreads[i-1], NULL, stress_student, (void*) i);
+  for (i = 0; i < num_students; i++)
+    pthread_join(sthreads[i], NULL);
+  pthread_join(gthread, &checks);
+  double elapsed = now_sec() - start;
+
+  long ops = num_students * ops_per_thread + (long) checks;
+  printf("%-10s | %-7s | %8d | %12ld | %14.0f   (%ld guard checks)\n",
+         impl->name, room_policy_name(policy), num_students + 1, ops,
+         ops / elapsed, (long) checks);
+
+  impl->destroy(room);
+  free(sthreads);
+}
+
+int main(int argc, char** argv)
+{
+  ops_per_thread = argc > 1 ? atol(argv[1]) : 100000;
+  num_students   = argc > 2 ? atoi(argv[2]) : 16;
+  capacity       = argc > 3 ? atoi(argv[3]) : 4;
+
+  if (ops_per_thread <= 0 || num_students <= 0 || capacity <= 0) {
+    fprintf(stderr, "USAGE: %s [ops_per_thread] [num_students] [capacity]\n",
+            argv[0]);
+    return 1;
+  }
+
+  printf("Primitive  | Test    | Threads  | Operations   | Ops/sec\n");
+  stress_semaphore(num_students);
+  for (int p = 0; p < ROOM_NUM_POLICIES; p++) {
+    for (int k = 0; k < (int) (sizeof(impls) / sizeof(impls[0])); k++)
+      stress_room(&impls[k], (room_policy_t) p);
+  }
+  printf("all invariants held\n");
+  return 0;
+}
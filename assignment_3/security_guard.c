@@ -14,42 +14,44 @@ included in all copies or substantial portions of the Software.
 */
 
 // to compile enter:
-//    cc -Wall security_guard.c binary_semaphore.c -lpthread
-// NOTE: you will get a warning about unused variable, sthreads, but
-// this will go away, as you complete the code.
+//    cc -Wall -I../common security_guard.c sem_room.c room_policy.c binary_semaphore.c ../common/rng.c ../common/thread_launch.c -lpthread
+// threads are placed on CPUs as THREAD_PLACEMENT says (see thread_launch.h), e.g.
+//    THREAD_PLACEMENT=compact ./a.out 10 4 5
 
 #include <stdio.h>
-#include <stdlib.h>  // for exit(), rand(), strtol()
+#include <stdlib.h>  // for exit(), strtol()
 #include <pthread.h>
 #include <time.h>    // for nanosleep()
 #include <errno.h>   // for EINTR error check in millisleep()
 
 #include "binary_semaphore.h"
+#include "sem_room.h"
+#include "rng.h"
+#include "thread_launch.h"
 
 // you can adjust next two values to speedup/slowdown the simulation
 #define MIN_SLEEP      20   // minimum sleep time in milliseconds
 #define MAX_SLEEP     100   // maximum sleep time in milliseconds
 
-#define START_SEED     11   // arbitrary value to seed random number generator
+#define START_SEED     11   // arbitrary value to seed random number generators
 
-// guard_state with a value of k:
-//          k < 0 : means guard is waiting in the room
-//          k = 0 : means guard is in the hall of department
-//          k > 0 : means guard is IN the room
-int guard_state;         // waiting, in the hall, or in the room
-int num_students;        // number of students in the room
+// the room keeps guard_state and num_students, and all of the
+// semaphores needed to synchronize the guard with the students
+sem_room room;
 
-// TODO:  list here the "handful" of semaphores you will need to synchronize
-//        I've listed one you will need for sure, to "get you going"
-binary_semaphore mutex;  // to protect shared variables (including semaphores)
-binary_semaphore room_empty; // Signal if the room is empty or not
+// rngs[0] is the guard's generator, rngs[k] the one of student k; each
+// is a separate stream of START_SEED on its own cache line
+rng_t *rngs;             // random generators for guard and students delays
 
-// will malloc space for seeds[] in the main
-unsigned int *seeds;     // rand seeds for guard and students generating delays
+// the calling thread's copy of its generator, made by the thread itself
+// so it sits in memory local to the thread's CPU
+_Thread_local rng_t *my_rng;
 
 // NOTE:  globals below are initialized by command line args and never changed !
 int capacity;       // maximum number of students in a room
 int num_checks;     // number of checks the guard makes
+int policy;         // room admission policy while the guard waits
+int bypass_limit;   // students let past a waiting guard (bypass policy)
 
 void millisleep(long millisecs)   // delay for "millisecs" milliseconds
 { // details of this function are unimportant for the assignment
@@ -62,16 +64,16 @@ void millisleep(long millisecs)   // delay for "millisecs" milliseconds
 }
 
 // generate random int in range [min, max]
-int rand_range(unsigned int *seedptr, long min, long max)
+int rand_range(rng_t *rng, long min, long max)
 { // details of this function are unimportant for the assignment
-  // using reentrante version of rand() function (because multithreaded)
+  // every thread draws from its own generator (because multithreaded)
   // NOTE: however, overall behavior of code will still be non-deterministic
-  return min + rand_r(seedptr) % (max - min + 1);
+  return rng_range(rng, min, max);
 }
 
-void study(long id)  // student studies for some random time
+void study(long id, int num_students)  // student studies for some random time
 { // details of this function are unimportant for the assignment
-  int ms = rand_range(&seeds[id], MIN_SLEEP, MAX_SLEEP);
+  int ms = rand_range(my_rng, MIN_SLEEP, MAX_SLEEP);
   printf("student %2ld studying in room with %2d students for %3d millisecs\n",
 	 id, num_students, ms);
   millisleep(ms);
@@ -79,15 +81,14 @@ void study(long id)  // student studies for some random time
 
 void do_something_else(long id)    // student does something else
 { // details of this function are unimportant for the assignment
-  int ms = rand_range(&seeds[id], MIN_SLEEP, MAX_SLEEP);
+  int ms = rand_range(my_rng, MIN_SLEEP, MAX_SLEEP);
   millisleep(ms);
 }
 
 void assess_security()  // guard assess room security
 { // details of this function are unimportant for the assignment
-  // NOTE:  we have (own) the mutex when we first enter this routine
-  guard_state = 1;     // positive means in the room
-  int ms = rand_range(&seeds[0], MIN_SLEEP, MAX_SLEEP/2);
+  // NOTE:  the room is ours (no students) when we enter this routine
+  int ms = rand_range(my_rng, MIN_SLEEP, MAX_SLEEP/2);
   printf("\tguard assessing room security for %3d millisecs...\n", ms);
   millisleep(ms);
   printf("\tguard done assessing room security\n");
@@ -95,7 +96,7 @@ void assess_security()  // guard assess room security
 
 void guard_walk_hallway()  // guard walks the hallway
 { // details of this function are unimportant for the assignment
-  int ms = rand_range(&seeds[0], MIN_SLEEP, MAX_SLEEP/2);
+  int ms = rand_range(my_rng, MIN_SLEEP, MAX_SLEEP/2);
   printf("\tguard walking the hallway for %3d millisecs...\n", ms);
   millisleep(ms);
 }
@@ -120,18 +121,14 @@ void guard_check_room()
   // (eg. num_students), you need to insure you are doing so in a
   // mutually exclusive fashion, for example, by calling
   // semWait(&mutex).
-  semWaitB(&mutex); // Protect access to shared variables
-  if (num_students > 0) {
-    // Guard waits for the room to be empty
-    semSignalB(&mutex); // Release mutex to allow students to leave
-    semWaitB(&room_empty); // Wait for signal that room is empty
-    semWaitB(&mutex); // Acquire mutex again to assess the room
+  int found = sem_room_guard_enter(&room);
+  if (found > 0) {
+    printf("\tguard done waiting to enter room with %2d students\n", found);
   }
 
   // Room is empty, assess security
   assess_security();
-  guard_state = 0; // Guard leaves the room
-  semSignalB(&mutex);
+  sem_room_guard_leave(&room); // Guard leaves the room
 }
 
 // this function contains the main synchronization logic for a student
@@ -145,35 +142,31 @@ void student_study_in_room(long id)
   // study(), above.  You will also need to properly maintain the
   // global variable, num_students.  When done, students leave the
   // room.
-  semWaitB(&mutex); // Protect access to shared variables
-  while (guard_state != 0) { // Wait if guard is in the room
-    semSignalB(&mutex);
-    // Implement logic to wait for guard to leave if necessary
-    do_something_else(id);
-    semWaitB(&mutex);
-  }
-  num_students++;
-  // if (num_students == 1) {
-  //   // First student in the room might need to reset room_empty semaphore
-  // }
-  semSignalB(&mutex);
-
-  study(id); // Student studies
-
-  semWaitB(&mutex);
-  num_students--;
-  if (num_students == 0) {
-    // Last student signals the guard if waiting
-    semSignalB(&room_empty);
+  int n = sem_room_student_enter(&room); // waits out the guard
+
+  study(id, n); // Student studies
+
+  sem_room_student_leave(&room); // last one out lets a waiting guard in
+}
+
+// this thread's own copy of a generator, on its NUMA node
+static rng_t* local_rng(const rng_t* from)
+{
+  rng_t* copy = thread_local_alloc(sizeof(rng_t));
+  if (copy == NULL) {
+    fprintf(stderr, "out of memory for a random generator\n");
+    exit(1);
   }
-  semSignalB(&mutex);
+  *copy = *from;
+  return copy;
 }
 
 // guard thread function  --- NO need to change this function !
 void* guard(void* arg)
 {
   int i;            // loop control variable
-  srand(seeds[0]);  // seed the guard thread random number generator
+
+  my_rng = local_rng(&rngs[0]);
 
   // the guard repeatedly checks the room (limited to num_checks) and
   // walks the hallway
@@ -182,6 +175,7 @@ void* guard(void* arg)
     guard_walk_hallway();
   }
 
+  free(my_rng);
   return NULL;   // thread needs to return a void*
 }
 
@@ -189,7 +183,10 @@ void* guard(void* arg)
 void* student(void* arg)
 {
   long id = (long) arg;  // determine thread id from arg
-  srand(seeds[id]);      // seed this threads random number generator
+
+  // never freed: students run until main() cancels them and exits,
+  // and the process exit reclaims it
+  my_rng = local_rng(&rngs[id]);
 
   // repeatedly study and do something else
   while (1) {
@@ -208,14 +205,15 @@ int main(int argc, char** argv)  // the main function
   long i;                  // loop control variable
 
   if (argc < 4) {
-    fprintf(stderr, "USAGE: %s num_threads capacity num_checks\n", argv[0]);
+    fprintf(stderr, "USAGE: %s num_threads capacity num_checks "
+            "[student|guard|bypass [bypass_limit]]\n", argv[0]);
     return 0;
   }
 
   // TODO: get three input parameters, convert, and properly store
 
-  // TODO: allocate space for the seeds[] array
-  // NOTE: seeds[0] is guard seed, seeds[k] is the seed for student k
+  // TODO: allocate space for the rngs[] array
+  // NOTE: rngs[0] is guard generator, rngs[k] the generator of student k
 
   // TODO: allocate space for the student threads array, sthreads
 
@@ -226,28 +224,32 @@ int main(int argc, char** argv)  // the main function
   n = atoi(argv[1]);
   capacity = atoi(argv[2]);
   num_checks = atoi(argv[3]);
+  policy = argc > 4 ? room_policy_parse(argv[4]) : ROOM_STUDENT_PRIORITY;
+  bypass_limit = argc > 5 ? atoi(argv[5]) : capacity;
+  if (policy < 0) {
+    fprintf(stderr, "%s: unknown admission policy %s\n", argv[0], argv[4]);
+    return 1;
+  }
 
-  // Allocate space for the seeds array
-  seeds = (unsigned int*)malloc((n + 1) * sizeof(unsigned int)); // +1 for the guard
+  // Allocate and seed the generators, one stream per thread
+  rngs = rng_streams(n + 1, START_SEED); // +1 for the guard
 
   // Allocate space for the student threads array
   sthreads = (pthread_t*)malloc(n * sizeof(pthread_t));
+  if (rngs == NULL || sthreads == NULL) {
+    fprintf(stderr, "%s: out of memory\n", argv[0]);
+    return 1;
+  }
   //====================================================
-  guard_state = 0;   // not in room (walking the hall)
-  num_students = 0;  // number of students in the room
-
-  semInitB(&mutex, 1);  // initialize mutex
-  // TODO: complete the semaphore initializations, for all your semaphores
-  semInitB(&room_empty, 0); // Initially, the room is not empty
-  // initialize guard seed and create the guard thread
-  seeds[0] = START_SEED;
-  pthread_create(&cthread, NULL, guard, (void*) NULL);
+  // guard not in room (walking the hall), no students in the room
+  sem_room_init(&room, capacity, (room_policy_t) policy, bypass_limit);
+
+  // create the guard thread
+  thread_launch(&cthread, 0, guard, (void*) NULL);
   
   for (i = 1; i <= n; i++) {
-    // TODO: create the student threads and initialize seeds[k], for
-    // each student k
-    seeds[i] = START_SEED + i; // Initialize seed for student i
-    pthread_create(&sthreads[i-1], NULL, student, (void*) i);
+    // TODO: create the student threads
+    thread_launch(&sthreads[i-1], (int) i, student, (void*) i);
 
   }
 
@@ -260,7 +262,7 @@ int main(int argc, char** argv)  // the main function
   }
 
   // TODO: free up any dynamic memory you allocated
-  free(seeds);
+  free(rngs);
   free(sthreads);
   
   return 0;
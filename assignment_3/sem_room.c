@@ -0,0 +1,138 @@
+#include <sched.h>   // for sched_yield()
+#include "sem_room.h"
+#include "perturb.h"
+
+void sem_room_init(sem_room* r, int capacity,
+                   room_policy_t policy, int bypass_limit)
+{
+  semInitB(&r->mutex, 1);       // room state is free to examine
+  semInitB(&r->room_empty, 0);  // nobody has signalled an empty room yet
+  semInitB(&r->door, 1);        // door is open
+  r->guard_state  = 0;          // not in room (walking the hall)
+  r->num_students = 0;
+  r->capacity     = capacity;
+  r->policy       = policy;
+  r->bypass_limit = bypass_limit;
+  r->bypassed     = 0;
+  r->door_closed  = 0;
+}
+
+void sem_room_destroy(sem_room* r)
+{
+  semDestroyB(&r->door);
+  semDestroyB(&r->room_empty);
+  semDestroyB(&r->mutex);
+}
+
+// NOTE: both functions below are called with "mutex" held.  Holding
+// "mutex" while waiting on "door" is safe: the only other holders of
+// "door" are students passing through it, who don't need "mutex".
+static void close_door(sem_room* r)
+{
+  if (!r->door_closed) {
+    semWaitB(&r->door);
+    r->door_closed = 1;
+  }
+}
+
+static void open_door(sem_room* r)
+{
+  if (r->door_closed) {
+    r->door_closed = 0;
+    semSignalB(&r->door);
+  }
+}
+
+// may a student come in while the guard is waiting?
+static int may_bypass(sem_room* r)
+{
+  switch (r->policy) {
+  case ROOM_STUDENT_PRIORITY: return 1;
+  case ROOM_BOUNDED_BYPASS:   return r->bypassed < r->bypass_limit;
+  default:                    return 0;
+  }
+}
+
+int sem_room_student_enter(sem_room* r)
+{
+  int n;
+
+  while (1) {
+    // blocks here while the door is closed
+    semWaitB(&r->door);
+    PERTURB();
+    semSignalB(&r->door);
+
+    // While the guard is in the room it holds "mutex" (see
+    // sem_room_guard_enter()), so a student blocks right here until the
+    // guard leaves.
+    semWaitB(&r->mutex);
+    if (r->guard_state < 0 && !may_bypass(r)) {
+      // the guard goes first: shut the door on ourselves and the
+      // students behind us, it is opened when the guard leaves
+      close_door(r);
+      semSignalB(&r->mutex);
+      continue;
+    }
+    if (r->num_students < r->capacity)
+      break;
+
+    // room is full: step out of the way and try again
+    semSignalB(&r->mutex);
+    sched_yield();
+  }
+  if (r->guard_state < 0)
+    r->bypassed++;
+  n = ++r->num_students;
+  semSignalB(&r->mutex);
+
+  return n;
+}
+
+void sem_room_student_leave(sem_room* r)
+{
+  semWaitB(&r->mutex);
+  r->num_students--;
+  PERTURB();
+  if (r->num_students == 0 && r->guard_state < 0) {
+    // last student out lets the waiting guard in
+    semSignalB(&r->room_empty);
+  }
+  semSignalB(&r->mutex);
+}
+
+int sem_room_guard_enter(sem_room* r)
+{
+  int found;
+
+  semWaitB(&r->mutex);
+  found = r->num_students;
+  if (r->num_students > 0) {
+    r->guard_state = -1;  // negative means waiting
+    r->bypassed    = 0;
+    if (!may_bypass(r))
+      close_door(r);
+  }
+  while (r->num_students > 0) {
+    // wait for the room to empty, letting students leave meanwhile
+    semSignalB(&r->mutex);
+    PERTURB();
+    semWaitB(&r->room_empty);
+    semWaitB(&r->mutex);
+
+    // room_empty may be stale (another student emptied the room since
+    // it was signalled), so the count is always checked again
+  }
+  r->guard_state = 1;  // positive means in the room
+
+  // NOTE: "mutex" is kept until sem_room_guard_leave(), which keeps
+  // every student out while the guard is in the room
+  return found;
+}
+
+void sem_room_guard_leave(sem_room* r)
+{
+  r->guard_state = 0;  // guard is back in the hall
+  open_door(r);
+  semSignalB(&r->mutex);
+}
@@ -0,0 +1,40 @@
+#ifndef sem_room_impl_h
+#define sem_room_impl_h
+
+#include "binary_semaphore.h"
+#include "room_policy.h"
+
+// Room protocol for the security guard problem, built only from
+// binary semaphores.  Every enter and leave goes through "mutex".
+//
+// guard_state with a value of k:
+//          k < 0 : means guard is waiting to enter the room
+//          k = 0 : means guard is in the hall of department
+//          k > 0 : means guard is IN the room
+typedef struct {
+  binary_semaphore mutex;        // protects every field below
+  binary_semaphore room_empty;   // last student out wakes a waiting guard
+  binary_semaphore door;         // students pass through it on the way in;
+                                 //   held down while the door is closed
+  int              guard_state;  // waiting, in the hall, or in the room
+  int              num_students; // number of students in the room
+  int              capacity;     // maximum number of students in the room
+  room_policy_t    policy;       // who goes first while the guard waits
+  int              bypass_limit; // ROOM_BOUNDED_BYPASS: students let in
+  int              bypassed;     //   while waiting, and how many so far
+  int              door_closed;  // 1 while "door" is held down
+} sem_room;
+
+void sem_room_init         (sem_room* r, int capacity,
+                            room_policy_t policy, int bypass_limit);
+void sem_room_destroy      (sem_room* r);
+
+// student_enter returns the number of students in the room, including
+// the caller; guard_enter returns the number of students the guard
+// found in the room when it arrived (0 if it walked straight in)
+int  sem_room_student_enter(sem_room* r);
+void sem_room_student_leave(sem_room* r);
+int  sem_room_guard_enter  (sem_room* r);
+void sem_room_guard_leave  (sem_room* r);
+
+#endif // sem_room_impl_h
@@ -1,6 +1,10 @@
+// to compile enter:
+//    cc -Wall -I../common main.c mem.c ../common/rng.c -o fits
+
 #include <stdio.h>
 #include <stdlib.h>
 #include "mem.h"
+#include "rng.h"
 
 int main(int argc, char** argv) {
     if (argc != 5) {
@@ -13,12 +17,13 @@ int main(int argc, char** argv) {
     int runs = atoi(argv[3]);
     int seed = atoi(argv[4]);
 
-    srand(seed);
+    rng_t rng;                 // request sizes and durations come from here
+    rng_seed(&rng, seed);
     mem_init(mem_size);
 
     // Loop over strategies
     printf("Strategy   | Average Failures | Average Fragments | Average Probes\n");
-    for (int strategy = BESTFIT; strategy <= NEXTFIT; strategy++) {
+    for (int strategy = BESTFIT; strategy <= LIFETIMEFIT; strategy++) {
         mem_strats_t current_strategy = (mem_strats_t)strategy; // Cast int to enum
         //printf("\nCurrent strategy: %d\n", current_strategy);
 
@@ -26,6 +31,7 @@ int main(int argc, char** argv) {
         if (current_strategy == 0) strategy_string = "Best Fit";
         if (current_strategy == 1) strategy_string = "First Fit";
         if (current_strategy == 2) strategy_string = "Next Fit";
+        if (current_strategy == 3) strategy_string = "Lifetime";
 
         double total_failures = 0, total_fragments = 0, total_probes = 0;
 
@@ -34,8 +40,8 @@ int main(int argc, char** argv) {
             int failures = 0, probes = 0;
 
             for (int time_unit = 0; time_unit < duration; time_unit++) {
-                int size = MIN_REQUEST_SIZE + (rand() % (MAX_REQUEST_SIZE - MIN_REQUEST_SIZE + 1));
-                dur_t alloc_duration = MIN_DURATION + (rand() % (MAX_DURATION - MIN_DURATION + 1));
+                int size = rng_range(&rng, MIN_REQUEST_SIZE, MAX_REQUEST_SIZE);
+                dur_t alloc_duration = rng_range(&rng, MIN_DURATION, MAX_DURATION);
                 int result = mem_allocate(current_strategy, size, alloc_duration);
 
                 if (result == -1) {
@@ -60,7 +66,7 @@ int main(int argc, char** argv) {
                total_probes / duration / runs);
     }
 
-    //printf("\nBESTFIT = 0, FIRSTFIT = 1, NEXTFIT = 2\n");
+    //printf("\nBESTFIT = 0, FIRSTFIT = 1, NEXTFIT = 2, LIFETIMEFIT = 3\n");
     mem_free();
     return 0;
 }
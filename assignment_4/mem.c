@@ -92,6 +92,53 @@ int mem_allocate(mem_strats_t strategy, int size, dur_t duration) {
             return probes; // Return the number of probes used to find the block
         }
         
+        return -1; // No suitable block found, return -1
+    } else if (strategy == LIFETIMEFIT) {
+        /*
+          A block can go at either end of a free hole, next to the
+          allocated unit just outside it; every unit holds its time
+          left, so a neighbour holding the block's duration expires
+          with it.  Pick the end whose neighbour's time left is
+          closest to the duration.  The ends of memory count as
+          neighbours too: the low end as a short-lived one, the high
+          end as a long-lived one, so short and long blocks collect at
+          opposite ends.  Ties go to the smaller hole, as in BESTFIT.
+        */
+        int bestIndex = -1;
+        int bestGap = MAX_DURATION + 1;
+        int bestHole = mem_size + 1;
+
+        for (int i = 0; i < mem_size; i++) {
+            probes++; // Increment probes for each memory check.
+            if (memory[i] == 0) { // Start of a potential block
+                int freeCount = 0;
+                while (i + freeCount < mem_size && memory[i + freeCount] == 0) {
+                    freeCount++;
+                }
+                if (freeCount >= size) {
+                    int left = i > 0 ? memory[i - 1] : MIN_DURATION;
+                    int right = i + freeCount < mem_size ? memory[i + freeCount] : MAX_DURATION;
+                    int leftGap = abs(left - duration);
+                    int rightGap = abs(right - duration);
+                    int gap = leftGap <= rightGap ? leftGap : rightGap;
+
+                    if (gap < bestGap || (gap == bestGap && freeCount < bestHole)) {
+                        bestIndex = leftGap <= rightGap ? i : i + freeCount - size;
+                        bestGap = gap;
+                        bestHole = freeCount;
+                    }
+                }
+                i += freeCount; // Skip the checked free block
+            }
+        }
+
+        if (bestIndex != -1) { // A suitable block has been found
+            for (int j = 0; j < size; j++) {
+                memory[bestIndex + j] = duration; // Allocate the block
+            }
+            return probes; // Return the number of probes used to find the block
+        }
+
         return -1; // No suitable block found, return -1
     }
     return -1; // If not FIRSTFIT or no other strategies are defined
@@ -7,7 +7,12 @@
 #define MAX_REQUEST_SIZE   57
 
 typedef unsigned char dur_t;     /* duration type (eg. unsigned char, int) */
-typedef enum mem_strats { BESTFIT, FIRSTFIT, NEXTFIT } mem_strats_t;
+/*
+  LIFETIMEFIT places a block against the neighbour whose remaining
+  duration is closest to its own, so the two free at the same time and
+  their space coalesces (see mem_allocate()).
+ */
+typedef enum mem_strats { BESTFIT, FIRSTFIT, NEXTFIT, LIFETIMEFIT } mem_strats_t;
 
 int mem_allocate(mem_strats_t strategy, int size, dur_t duration);
 
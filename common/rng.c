@@ -0,0 +1,56 @@
+#include <stdlib.h>  // for aligned_alloc()
+#include "rng.h"
+
+// expands one 64-bit seed into well mixed generator state
+static uint64_t splitmix64(uint64_t* x)
+{
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void rng_seed(rng_t* r, uint64_t seed)
+{
+  for (int i = 0; i < 4; i++)
+    r->s[i] = splitmix64(&seed);
+}
+
+void rng_jump(rng_t* r)
+{
+  static const uint64_t jump[] = {
+    0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+    0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+  };
+  uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+  for (int i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (jump[i] & (1ull << b)) {
+        s0 ^= r->s[0];
+        s1 ^= r->s[1];
+        s2 ^= r->s[2];
+        s3 ^= r->s[3];
+      }
+      rng_next(r);
+    }
+  }
+  r->s[0] = s0;
+  r->s[1] = s1;
+  r->s[2] = s2;
+  r->s[3] = s3;
+}
+
+rng_t* rng_streams(int n, uint64_t seed)
+{
+  rng_t* streams = aligned_alloc(RNG_CACHE_LINE, n * sizeof(rng_t));
+  if (streams == NULL || n <= 0)
+    return streams;
+
+  rng_seed(&streams[0], seed);
+  for (int i = 1; i < n; i++) {
+    streams[i] = streams[i-1];
+    rng_jump(&streams[i]);
+  }
+  return streams;
+}
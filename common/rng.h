@@ -0,0 +1,75 @@
+#ifndef rng_impl_h
+#define rng_impl_h
+
+#include <stdint.h>
+
+// Per-thread pseudo random number generator (xoshiro256**).  Each
+// thread owns one rng_t; the state is padded to a full cache line so
+// generators of neighbouring threads never share one.
+//
+// Streams are split reproducibly from a single seed: stream k starts
+// 2^128 draws after stream k-1, so streams never overlap and the same
+// seed always gives every thread the same sequence.
+
+#define RNG_CACHE_LINE  64
+
+typedef struct {
+  _Alignas(RNG_CACHE_LINE) uint64_t s[4];
+} rng_t;
+
+// seed a single generator (stream 0 of "seed")
+void   rng_seed   (rng_t* r, uint64_t seed);
+
+// advance r by 2^128 draws, to the start of the next stream
+void   rng_jump   (rng_t* r);
+
+// allocate n cache-line aligned generators, streams 0..n-1 of "seed";
+// release them with free()
+rng_t* rng_streams(int n, uint64_t seed);
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+// next 64 random bits
+static inline uint64_t rng_next(rng_t* r)
+{
+  uint64_t* s = r->s;
+  uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+
+  return result;
+}
+
+// uniform random integer in [0, n), without modulo bias (Lemire's
+// multiply-shift with rejection); n must be > 0
+static inline uint64_t rng_below(rng_t* r, uint64_t n)
+{
+  __uint128_t m = (__uint128_t) rng_next(r) * n;
+  uint64_t low = (uint64_t) m;
+
+  if (low < n) {
+    uint64_t threshold = -n % n;  // 2^64 mod n
+    while (low < threshold) {
+      m = (__uint128_t) rng_next(r) * n;
+      low = (uint64_t) m;
+    }
+  }
+  return (uint64_t) (m >> 64);
+}
+
+// uniform random integer in [min, max]
+static inline long rng_range(rng_t* r, long min, long max)
+{
+  return min + (long) rng_below(r, (uint64_t) (max - min) + 1);
+}
+
+#endif // rng_impl_h
@@ -0,0 +1,210 @@
+#define _GNU_SOURCE  // for cpu_set_t, pthread_attr_setaffinity_np()
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>  // for getenv(), strtol(), qsort(), aligned_alloc()
+#include <string.h>
+#include "thread_launch.h"
+
+#define LAUNCH_CACHE_LINE 64
+
+typedef struct {
+  int cpu;
+  int package;   // socket
+  int core;      // core id within the socket
+  int sibling;   // 0 for the first hyperthread of its core, 1 for the next, ...
+} cpu_info;
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static const char*    policy_name = "none";
+static int*           order;      // CPU for thread k is order[k % num_cpus]
+static int            num_cpus;   // 0: no pinning
+
+// a number from /sys/devices/system/cpu/cpuN/topology, or 0 if missing
+static int topology(int cpu, const char* name)
+{
+  char path[96];
+  int value = 0;
+
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+  FILE* f = fopen(path, "r");
+  if (f != NULL) {
+    if (fscanf(f, "%d", &value) != 1)
+      value = 0;
+    fclose(f);
+  }
+  return value;
+}
+
+static int by_package(const void* a, const void* b)
+{
+  const cpu_info* x = a;
+  const cpu_info* y = b;
+
+  if (x->package != y->package)
+    return x->package - y->package;
+  if (x->core != y->core)
+    return x->core - y->core;
+  return x->cpu - y->cpu;
+}
+
+// within a socket, one CPU of every core before any core's second one
+static int by_sibling(const void* a, const void* b)
+{
+  const cpu_info* x = a;
+  const cpu_info* y = b;
+
+  if (x->package != y->package)
+    return x->package - y->package;
+  if (x->sibling != y->sibling)
+    return x->sibling - y->sibling;
+  return by_package(a, b);
+}
+
+// "0,2,4-7" into order[], keeping only allowed CPUs; returns how many,
+// or -1 if it doesn't parse
+static int parse_list(const char* list, const cpu_set_t* allowed, int* out, int max)
+{
+  int n = 0;
+  const char* p = list;
+
+  while (*p) {
+    char* end;
+    long first = strtol(p, &end, 10), last = first;
+    if (end == p || first < 0)
+      return -1;
+    if (*end == '-') {
+      p = end + 1;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first)
+        return -1;
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, allowed) && n < max)
+        out[n++] = (int) cpu;
+    }
+    if (*end == ',')
+      end++;
+    else if (*end != '\0')
+      return -1;
+    p = end;
+  }
+  return n;
+}
+
+// works out order[] from THREAD_PLACEMENT, once per process
+static void init_placement(void)
+{
+  const char* env = getenv("THREAD_PLACEMENT");
+  cpu_set_t allowed;
+
+  if (env == NULL || *env == '\0' || strcmp(env, "none") == 0)
+    return;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    return;
+
+  int total = CPU_COUNT(&allowed);
+  cpu_info* cpus = malloc(total * sizeof(cpu_info));
+  order = malloc(total * sizeof(int));
+  if (cpus == NULL || order == NULL) {
+    free(cpus);
+    free(order);
+    order = NULL;
+    return;
+  }
+
+  int n = 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE && n < total; cpu++) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      cpus[n].cpu     = cpu;
+      cpus[n].package = topology(cpu, "physical_package_id");
+      cpus[n].core    = topology(cpu, "core_id");
+      n++;
+    }
+  }
+  qsort(cpus, n, sizeof(cpu_info), by_package);
+  for (int i = 0; i < n; i++) {
+    int same_core = i > 0 && cpus[i].package == cpus[i - 1].package &&
+                    cpus[i].core == cpus[i - 1].core;
+    cpus[i].sibling = same_core ? cpus[i - 1].sibling + 1 : 0;
+  }
+
+  if (strcmp(env, "compact") == 0) {
+    // socket by socket, and hyperthreads of a core next to each other
+    for (int i = 0; i < n; i++)
+      order[i] = cpus[i].cpu;
+    num_cpus = n;
+    policy_name = "compact";
+  } else if (strcmp(env, "scatter") == 0) {
+    // the i-th CPU of each socket in turn, each socket's CPUs taking
+    // every core once before the hyperthread siblings: first[] is where
+    // each socket's CPUs start in the sorted cpus[]
+    qsort(cpus, n, sizeof(cpu_info), by_sibling);
+    int* first = malloc((n + 1) * sizeof(int));
+    int sockets = 0;
+    for (int i = 0; first != NULL && i < n; i++) {
+      if (i == 0 || cpus[i].package != cpus[i - 1].package)
+        first[sockets++] = i;
+    }
+    if (first != NULL) {
+      first[sockets] = n;
+      for (int round = 0; num_cpus < n; round++) {
+        for (int s = 0; s < sockets; s++) {
+          if (first[s] + round < first[s + 1])
+            order[num_cpus++] = cpus[first[s] + round].cpu;
+        }
+      }
+      free(first);
+      policy_name = "scatter";
+    }
+  } else {
+    int listed = parse_list(env, &allowed, order, total);
+    if (listed > 0) {
+      num_cpus = listed;
+      policy_name = "list";
+    } else {
+      fprintf(stderr, "THREAD_PLACEMENT=%s: expected compact, scatter, none or a "
+              "list of allowed CPUs like 0,2,4-7; threads are not pinned\n", env);
+    }
+  }
+  free(cpus);
+}
+
+int thread_launch_cpu(int index)
+{
+  pthread_once(&once, init_placement);
+  return num_cpus > 0 ? order[index % num_cpus] : -1;
+}
+
+const char* thread_launch_policy(void)
+{
+  pthread_once(&once, init_placement);
+  return policy_name;
+}
+
+int thread_launch(pthread_t* thread, int index, void* (*fn)(void*), void* arg)
+{
+  int cpu = thread_launch_cpu(index);
+  pthread_attr_t attr;
+  cpu_set_t set;
+
+  if (cpu < 0)
+    return pthread_create(thread, NULL, fn, arg);
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  pthread_attr_init(&attr);
+  pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+  int err = pthread_create(thread, &attr, fn, arg);
+  pthread_attr_destroy(&attr);
+  return err;
+}
+
+void* thread_local_alloc(size_t bytes)
+{
+  size_t rounded = (bytes + LAUNCH_CACHE_LINE - 1) / LAUNCH_CACHE_LINE * LAUNCH_CACHE_LINE;
+  void* p = aligned_alloc(LAUNCH_CACHE_LINE, rounded ? rounded : LAUNCH_CACHE_LINE);
+
+  if (p != NULL)
+    memset(p, 0, rounded);   // first touch, from this thread
+  return p;
+}
@@ -0,0 +1,44 @@
+#ifndef thread_launch_impl_h
+#define thread_launch_impl_h
+
+#include <stddef.h>
+#include <pthread.h>
+
+// Thread creation with an optional CPU placement policy, read once from
+// the THREAD_PLACEMENT environment variable:
+//
+//    (unset) or none   no pinning: threads start like pthread_create()'s
+//    compact           thread k on the k-th CPU, filling the cores of
+//                      one socket (package) before the next one
+//    scatter           consecutive threads on different sockets, round
+//                      robin, and within a socket on different cores
+//                      before a core's second hyperthread, so a group
+//                      of threads spreads out
+//    0,2,4-7           an explicit CPU list, used round robin
+//
+// Only CPUs the process may run on (sched_getaffinity()) are used, and
+// thread k wraps around to the start when k exceeds them.  index is the
+// program's own number for the thread (0, 1, 2, ...), so a thread lands
+// on the same CPU in every run.  A pinned thread is pinned from its
+// first instruction, so memory it is the first to write comes from its
+// own NUMA node (Linux places a page where it is first written), such
+// as what it gets from thread_local_alloc().  Its stack does not: the
+// C library sets it up from the creating thread, whose node the first
+// pages land on.  An unknown policy is reported once on stderr and
+// ignored.
+//
+// Returns what pthread_create() returns.
+int   thread_launch(pthread_t* thread, int index, void* (*fn)(void*), void* arg);
+
+// The CPU thread index gets under the policy, or -1 if it isn't pinned.
+int   thread_launch_cpu(int index);
+
+// Name of the policy in effect ("none", "compact", "scatter" or "list").
+const char* thread_launch_policy(void);
+
+// bytes of cache-line aligned memory, written through once so that its
+// pages are placed on the NUMA node of the calling thread; call it from
+// the thread that will use the memory.  Release it with free().
+void* thread_local_alloc(size_t bytes);
+
+#endif // thread_launch_impl_h